@@ -0,0 +1,38 @@
+#include "Allocations.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    /// Number of heap allocations performed by the process.
+    std::atomic<std::size_t> count{0};
+}
+
+std::size_t allocations()
+{
+    return count.load();
+}
+
+void* operator new(std::size_t size)
+{
+    count.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
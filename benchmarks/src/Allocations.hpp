@@ -0,0 +1,13 @@
+#ifndef QTREE_BENCH_ALLOCATIONS_H_
+#define QTREE_BENCH_ALLOCATIONS_H_
+
+#include <cstddef>
+
+/// <summary>
+/// Gets the number of heap allocations performed by the process so far.
+/// </summary>
+/// <remarks>The global operator new and delete are replaced in their own translation
+/// unit, so that the compiler never sees them paired with the allocations they count.</remarks>
+std::size_t allocations();
+
+#endif
@@ -0,0 +1,466 @@
+#include "quadtree.hpp"
+using namespace qtree;
+
+#include "Allocations.hpp"
+#include "benchmark/benchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using TCoordinate = float;
+    using TElement = int;
+
+    template<std::size_t Depth>
+    using TQuadTree = quadtree<TElement, TCoordinate, Depth>;
+
+    template<std::size_t Depth>
+    using TCountQuadTree = quadtree<TElement, TCoordinate, Depth, count_aggregate>;
+
+    template<std::size_t Depth>
+    using TEpochQuadTree = quadtree<TElement, TCoordinate, Depth, void, true>;
+
+    using TElementsContainer = qnode<TElement, TCoordinate>::TElementRefContainer;
+
+    /// Number of elements of each workload.
+    constexpr std::size_t Elements() { return 1 << 16; }
+    /// Number of query areas of each workload.
+    constexpr std::size_t Queries() { return 1 << 10; }
+
+    constexpr TCoordinate Extent() { return 1024; }
+
+    enum Distribution { Uniform, Clustered, Skewed };
+    enum Shape { Points, LargeRects };
+    enum QuerySize { SmallArea, LargeArea };
+
+    /// <summary>
+    /// Reproducible generator of element and query bounds.
+    /// </summary>
+    class workload
+    {
+    public:
+
+        explicit workload(Distribution distribution)
+            : _distribution(distribution)
+            , _random(42)
+        {
+            std::uniform_real_distribution<TCoordinate> position(0, Extent());
+
+            for (auto& center : _clusters)
+            {
+                center = { position(_random), position(_random) };
+            }
+        }
+
+        /// <summary>
+        /// Gets the bounds of the given number of elements of the given shape.
+        /// </summary>
+        std::vector<rect<TCoordinate>> elements(Shape shape, std::size_t count)
+        {
+            std::uniform_real_distribution<TCoordinate> size(Extent() / 100, Extent() / 10);
+            std::vector<rect<TCoordinate>> bounds;
+            bounds.reserve(count);
+
+            for (std::size_t i = 0; i < count; i++)
+            {
+                const auto width = shape == Points ? 0 : size(_random);
+                const auto height = shape == Points ? 0 : size(_random);
+                bounds.push_back(around(next(), width, height));
+            }
+
+            return bounds;
+        }
+
+        /// <summary>
+        /// Gets the given number of query areas of the given size, uniformly distributed.
+        /// </summary>
+        std::vector<rect<TCoordinate>> areas(QuerySize size, std::size_t count)
+        {
+            std::uniform_real_distribution<TCoordinate> position(0, Extent());
+            const auto extent = size == SmallArea ? Extent() / 100 : Extent() / 4;
+            std::vector<rect<TCoordinate>> bounds;
+            bounds.reserve(count);
+
+            for (std::size_t i = 0; i < count; i++)
+            {
+                bounds.push_back(around({ position(_random), position(_random) }, extent, extent));
+            }
+
+            return bounds;
+        }
+
+
+    private:
+
+        using TPoint = std::pair<TCoordinate, TCoordinate>;
+
+        static TCoordinate clamp(TCoordinate value)
+        {
+            return std::min(std::max(value, TCoordinate{0}), Extent());
+        }
+
+        static rect<TCoordinate> around(TPoint center, TCoordinate width, TCoordinate height)
+        {
+            const auto left = clamp(center.first - width / 2);
+            const auto top = clamp(center.second - height / 2);
+            return rect<TCoordinate>(left, top, clamp(left + width), clamp(top + height));
+        }
+
+        TPoint next()
+        {
+            std::uniform_real_distribution<TCoordinate> unit(0, 1);
+
+            switch (_distribution)
+            {
+            case Clustered:
+            {
+                std::uniform_int_distribution<std::size_t> cluster(0, _clusters.size() - 1);
+                std::normal_distribution<TCoordinate> offset(0, Extent() / 50);
+                const auto& center = _clusters[cluster(_random)];
+                return { clamp(center.first + offset(_random)), clamp(center.second + offset(_random)) };
+            }
+            case Skewed:
+                // most of the elements are close to the top-left corner
+                return { Extent() * std::pow(unit(_random), 4.f), Extent() * std::pow(unit(_random), 4.f) };
+            default:
+                return { Extent() * unit(_random), Extent() * unit(_random) };
+            }
+        }
+
+        const Distribution _distribution;
+        std::mt19937 _random;
+        std::array<TPoint, 16> _clusters;
+    };
+
+    /// <summary>
+    /// Gets the quad tree of the given depth and type shared by all the benchmarks (the deepest trees
+    /// take a long time to be constructed). The tree is empty when a benchmark starts.
+    /// </summary>
+    template<std::size_t Depth, typename TTree = TQuadTree<Depth>>
+    TTree& shared_tree()
+    {
+        static std::unique_ptr<TTree> tree(new TTree({ 0, 0, Extent(), Extent() }));
+        return *tree;
+    }
+
+    template<typename TTree>
+    void fill(TTree& tree, const std::vector<rect<TCoordinate>>& bounds)
+    {
+        TElement element{};
+
+        for (const auto& b : bounds)
+        {
+            tree.insert(element++, b);
+        }
+    }
+
+    /// <summary>
+    /// Reports the average number of nodes visited by the given queries, measured through
+    /// the traversal counters (only if QTREE_ENABLE_STATS is defined) outside of the timed loop.
+    /// </summary>
+    template<typename TQueries>
+    void report_nodes(benchmark::State& state, std::size_t queries, TQueries&& run)
+    {
+#ifdef QTREE_ENABLE_STATS
+        traversal_counters() = qcounters();
+        run();
+        state.counters["nodes"] = static_cast<double>(traversal_counters().query_nodes) / queries;
+#else
+        (void)state;
+        (void)queries;
+        (void)run;
+#endif
+    }
+
+    /// <summary>
+    /// Reports the heap allocations performed since the given count.
+    /// </summary>
+    void report_allocations(benchmark::State& state, std::size_t since)
+    {
+        state.counters["allocs"] = benchmark::Counter(
+            static_cast<double>(allocations() - since), benchmark::Counter::kAvgIterations);
+    }
+
+    void workload_arguments(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "distribution", "shape" });
+
+        for (auto distribution : { Uniform, Clustered, Skewed })
+        {
+            for (auto shape : { Points, LargeRects })
+            {
+                benchmark->Args({ distribution, shape });
+            }
+        }
+    }
+
+    void query_arguments(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "distribution", "shape", "area" });
+
+        for (auto distribution : { Uniform, Clustered, Skewed })
+        {
+            for (auto shape : { Points, LargeRects })
+            {
+                for (auto area : { SmallArea, LargeArea })
+                {
+                    benchmark->Args({ distribution, shape, area });
+                }
+            }
+        }
+    }
+}
+
+template<std::size_t Depth>
+static void BM_Construct(benchmark::State& state)
+{
+    const auto since = allocations();
+
+    for (auto _ : state)
+    {
+        TQuadTree<Depth> tree({ 0, 0, Extent(), Extent() });
+        benchmark::DoNotOptimize(tree);
+    }
+
+    report_allocations(state, since);
+}
+
+template<std::size_t Depth>
+static void BM_Insert(benchmark::State& state)
+{
+    auto& tree = shared_tree<Depth>();
+    const auto bounds = workload(static_cast<Distribution>(state.range(0)))
+        .elements(static_cast<Shape>(state.range(1)), Elements());
+
+    std::size_t allocated = 0;
+
+    for (auto _ : state)
+    {
+        const auto since = allocations();
+        fill(tree, bounds);
+        allocated += allocations() - since;
+
+        state.PauseTiming();
+        tree.clear();
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * bounds.size()));
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocated), benchmark::Counter::kAvgIterations);
+}
+
+template<std::size_t Depth>
+static void BM_QueryArea(benchmark::State& state)
+{
+    auto& tree = shared_tree<Depth>();
+    workload load(static_cast<Distribution>(state.range(0)));
+    fill(tree, load.elements(static_cast<Shape>(state.range(1)), Elements()));
+    const auto areas = load.areas(static_cast<QuerySize>(state.range(2)), Queries());
+
+    TElementsContainer elements;
+    std::size_t returned = 0;
+    const auto since = allocations();
+
+    for (auto _ : state)
+    {
+        for (const auto& area : areas)
+        {
+            elements.clear();
+            tree.query(area, elements);
+            returned += elements.size();
+        }
+    }
+
+    const auto queries = static_cast<double>(state.iterations() * areas.size());
+    state.SetItemsProcessed(static_cast<std::int64_t>(queries));
+    state.counters["results"] = returned / queries;
+    report_allocations(state, since);
+
+    report_nodes(state, areas.size(), [&tree, &areas, &elements]()
+    {
+        for (const auto& area : areas)
+        {
+            elements.clear();
+            tree.query(area, elements);
+        }
+    });
+
+    tree.clear();
+}
+
+template<std::size_t Depth>
+static void BM_AggregateCount(benchmark::State& state)
+{
+    // a separate tree, since the shared ones keep no summaries
+    TCountQuadTree<Depth> tree({ 0, 0, Extent(), Extent() });
+    workload load(static_cast<Distribution>(state.range(0)));
+    fill(tree, load.elements(static_cast<Shape>(state.range(1)), Elements()));
+    const auto areas = load.areas(static_cast<QuerySize>(state.range(2)), Queries());
+
+    std::size_t counted = 0;
+    const auto since = allocations();
+
+    for (auto _ : state)
+    {
+        for (const auto& area : areas)
+        {
+            counted += tree.aggregate(area);
+        }
+    }
+
+    const auto queries = static_cast<double>(state.iterations() * areas.size());
+    state.SetItemsProcessed(static_cast<std::int64_t>(queries));
+    state.counters["results"] = counted / queries;
+    report_allocations(state, since);
+}
+
+/// <summary>
+/// Queries the areas of slowly moving viewers for a few frames, with or without a query context for each viewer.
+/// </summary>
+template<std::size_t Depth>
+static void query_frames(benchmark::State& state, bool coherent)
+{
+    constexpr std::size_t frames = 16;
+
+    // both variants query a tree with epochs, so that they differ only by the context
+    auto& tree = shared_tree<Depth, TEpochQuadTree<Depth>>();
+    workload load(static_cast<Distribution>(state.range(0)));
+    fill(tree, load.elements(static_cast<Shape>(state.range(1)), Elements()));
+    const auto areas = load.areas(static_cast<QuerySize>(state.range(2)), Queries() / frames);
+
+    std::vector<qcontext<TElement, rect<TCoordinate>>> contexts(areas.size());
+    TElementsContainer elements;
+    std::size_t returned = 0;
+
+    for (auto _ : state)
+    {
+        for (std::size_t frame = 0; frame < frames; frame++)
+        {
+            // the viewers move by one thousandth of the tree extent every other frame
+            const auto offset = Extent() / 1000 * static_cast<TCoordinate>(frame / 2);
+
+            for (std::size_t i = 0; i < areas.size(); i++)
+            {
+                const rect<TCoordinate> area(areas[i].left + offset, areas[i].top,
+                    areas[i].right + offset, areas[i].bottom);
+
+                elements.clear();
+
+                if (coherent)
+                {
+                    tree.query(area, elements, contexts[i]);
+                }
+                else
+                {
+                    tree.query(area, elements);
+                }
+
+                returned += elements.size();
+            }
+        }
+    }
+
+    const auto queries = static_cast<double>(state.iterations() * areas.size() * frames);
+    state.SetItemsProcessed(static_cast<std::int64_t>(queries));
+    state.counters["results"] = returned / queries;
+
+    tree.clear();
+}
+
+template<std::size_t Depth>
+static void BM_QueryFrames(benchmark::State& state)
+{
+    query_frames<Depth>(state, false);
+}
+
+template<std::size_t Depth>
+static void BM_QueryFramesCoherent(benchmark::State& state)
+{
+    query_frames<Depth>(state, true);
+}
+
+template<std::size_t Depth>
+static void BM_QueryAll(benchmark::State& state)
+{
+    auto& tree = shared_tree<Depth>();
+    fill(tree, workload(static_cast<Distribution>(state.range(0))).elements(static_cast<Shape>(state.range(1)), Elements()));
+
+    TElementsContainer elements;
+    const auto since = allocations();
+
+    for (auto _ : state)
+    {
+        elements.clear();
+        tree.query(elements);
+        benchmark::DoNotOptimize(elements.data());
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * elements.size()));
+    report_allocations(state, since);
+
+    report_nodes(state, 1, [&tree, &elements]()
+    {
+        elements.clear();
+        tree.query(elements);
+    });
+
+    tree.clear();
+}
+
+template<std::size_t Depth>
+static void BM_Size(benchmark::State& state)
+{
+    auto& tree = shared_tree<Depth>();
+    fill(tree, workload(Uniform).elements(Points, Elements()));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(tree.size());
+    }
+
+    tree.clear();
+}
+
+template<std::size_t Depth>
+static void BM_Clear(benchmark::State& state)
+{
+    auto& tree = shared_tree<Depth>();
+    const auto bounds = workload(Uniform).elements(Points, Elements());
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        fill(tree, bounds);
+        state.ResumeTiming();
+
+        tree.clear();
+    }
+}
+
+#define QTREE_BENCHMARK_DEPTHS(Benchmark, ...)                      \
+    BENCHMARK_TEMPLATE(Benchmark, 4)__VA_ARGS__;                    \
+    BENCHMARK_TEMPLATE(Benchmark, 6)__VA_ARGS__;                    \
+    BENCHMARK_TEMPLATE(Benchmark, 8)__VA_ARGS__;                    \
+    BENCHMARK_TEMPLATE(Benchmark, 10)__VA_ARGS__;                   \
+    BENCHMARK_TEMPLATE(Benchmark, 12)__VA_ARGS__
+
+QTREE_BENCHMARK_DEPTHS(BM_Construct, ->Unit(benchmark::kMillisecond));
+QTREE_BENCHMARK_DEPTHS(BM_Insert, ->Apply(workload_arguments)->Unit(benchmark::kMicrosecond));
+QTREE_BENCHMARK_DEPTHS(BM_QueryArea, ->Apply(query_arguments)->Unit(benchmark::kMicrosecond));
+BENCHMARK_TEMPLATE(BM_AggregateCount, 4)->Apply(query_arguments)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_AggregateCount, 6)->Apply(query_arguments)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_AggregateCount, 8)->Apply(query_arguments)->Unit(benchmark::kMicrosecond);
+QTREE_BENCHMARK_DEPTHS(BM_QueryFrames, ->Apply(query_arguments)->Unit(benchmark::kMicrosecond));
+QTREE_BENCHMARK_DEPTHS(BM_QueryFramesCoherent, ->Apply(query_arguments)->Unit(benchmark::kMicrosecond));
+QTREE_BENCHMARK_DEPTHS(BM_QueryAll, ->Apply(workload_arguments)->Unit(benchmark::kMicrosecond));
+QTREE_BENCHMARK_DEPTHS(BM_Size, ->Unit(benchmark::kMicrosecond));
+QTREE_BENCHMARK_DEPTHS(BM_Clear, ->Unit(benchmark::kMicrosecond));
+
+BENCHMARK_MAIN();
@@ -0,0 +1,136 @@
+#ifndef QTREE_BOX_H_
+#define QTREE_BOX_H_
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace qtree
+{
+    template<typename T, std::size_t N>
+    class box
+    {
+        /// Index of a dimension, used to unroll the loops over the dimensions at compile time.
+        template<std::size_t I>
+        using TAxis = std::integral_constant<std::size_t, I>;
+
+    public:
+
+        /// Point in the N-dimensional space.
+        using TPoint = std::array<T, N>;
+
+        /// <summary>
+        /// Zero initializes the box's coordinates.
+        /// </summary>
+        box() noexcept
+            : lower{}
+            , upper{}
+        {
+        }
+
+        /// <summary>
+        /// Initialises the instance with the given corners.
+        /// Throws std::invalid_argument if any coordinate of the upper corner
+        /// is smaller than the same coordinate of the lower corner.
+        /// </summary>
+        /// <param name="lower">Corner with the smallest coordinates.</param>
+        /// <param name="upper">Corner with the greatest coordinates.</param>
+        box(const TPoint& lower, const TPoint& upper)
+            : lower(lower)
+            , upper(valid(lower, upper, TAxis<0>()) ? upper : throw std::invalid_argument("Invalid coordinates."))
+        {
+        }
+
+        /// <summary>
+        /// Gets the number of dimensions of the box.
+        /// </summary>
+        constexpr static std::size_t dimensions() noexcept
+        {
+            return N;
+        }
+
+        /// <summary>
+        /// Returns true only if the given box is different
+        /// from this, otherwise returns false.
+        /// </summary>
+        bool operator!=(const box& box) const noexcept
+        {
+            return lower != box.lower || upper != box.upper;
+        }
+
+        /// <summary>
+        /// Returns true only if the given box is equal
+        /// from this, otherwise returns false.
+        /// </summary>
+        bool operator==(const box& box) const noexcept
+        {
+            return !(*this != box);
+        }
+
+        /// <summary>
+        /// Gets the size of the box along the given dimension.
+        /// </summary>
+        T extent(std::size_t dimension) const noexcept
+        {
+            return upper[dimension] - lower[dimension];
+        }
+
+        /// <summary>
+        /// Returns true only if the given box can fit inside this, otherwise returns false.
+        /// </summary>
+        bool contains(const box& box) const noexcept
+        {
+            return contains(box, TAxis<0>());
+        }
+
+        /// <summary>
+        /// Returns true only if the given box overlaps this, otherwise returns false.
+        /// </summary>
+        bool overlaps(const box& box) const noexcept
+        {
+            return overlaps(box, TAxis<0>());
+        }
+
+        TPoint lower;
+        TPoint upper;
+
+
+    private:
+
+        template<std::size_t I>
+        static bool valid(const TPoint& lower, const TPoint& upper, TAxis<I>) noexcept
+        {
+            return !(upper[I] < lower[I]) && valid(lower, upper, TAxis<I + 1>());
+        }
+
+        static bool valid(const TPoint&, const TPoint&, TAxis<N>) noexcept
+        {
+            return true;
+        }
+
+        template<std::size_t I>
+        bool contains(const box& box, TAxis<I>) const noexcept
+        {
+            return lower[I] <= box.lower[I] && upper[I] >= box.upper[I] && contains(box, TAxis<I + 1>());
+        }
+
+        bool contains(const box&, TAxis<N>) const noexcept
+        {
+            return true;
+        }
+
+        template<std::size_t I>
+        bool overlaps(const box& box, TAxis<I>) const noexcept
+        {
+            return lower[I] < box.upper[I] && upper[I] > box.lower[I] && overlaps(box, TAxis<I + 1>());
+        }
+
+        bool overlaps(const box&, TAxis<N>) const noexcept
+        {
+            return true;
+        }
+    };
+}
+
+#endif
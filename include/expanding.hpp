@@ -0,0 +1,392 @@
+#ifndef QTREE_EXPANDING_H_
+#define QTREE_EXPANDING_H_
+
+#include "ntree.hpp"
+#include "octree.hpp"
+#include "quadtree.hpp"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace qtree
+{
+    /// <summary>
+    /// Tree whose bounds grow to contain the elements inserted outside of them. Each time an
+    /// element does not fit, a new root twice as large is added on top of the current one,
+    /// which becomes one of its children and keeps its nodes and elements in place.
+    /// </summary>
+    /// <remarks>The depth of the tree is fixed at compile time, therefore the initial tree
+    /// keeps its resolution while the other children of each added root are created only
+    /// when needed, as trees of SiblingDepth levels. Since the trees allocate all their nodes
+    /// upfront, SiblingDepth bounds the memory allocated by each of these children.</remarks>
+    template<typename TElement, typename TBounds, std::size_t Depth,
+        std::size_t SiblingDepth = (Depth < 4 ? Depth : 4)>
+    class expanding_tree
+    {
+        using TTraits = bounds_traits<TBounds>;
+        using TTree = ntree<TElement, TBounds, Depth>;
+        using TSibling = ntree<TElement, TBounds, SiblingDepth>;
+        using TNode = qnode<TElement, typename TTraits::coordinate, TBounds>;
+
+        static_assert(Depth > 0, "The tree depth must be greater than zero.");
+        static_assert(SiblingDepth <= Depth, "The siblings depth must not exceed the tree depth.");
+
+
+    public:
+
+        /// Vector of references to the tree items.
+        using TElementRefContainer = typename TNode::TElementRefContainer;
+
+        /// <summary>
+        /// Initializes the instance with the given initial bounds.
+        /// </summary>
+        /// <param name="bounds">Initial tree bounds.</param>
+        explicit expanding_tree(TBounds bounds)
+            : _core(std::move(bounds))
+        {
+        }
+
+        /// <summary>
+        /// Gets the depth of the initial tree.
+        /// </summary>
+        constexpr static std::size_t depth()
+        {
+            return Depth;
+        }
+
+        /// <summary>
+        /// Gets the depth of the children created by the added roots.
+        /// </summary>
+        constexpr static std::size_t sibling_depth()
+        {
+            return SiblingDepth;
+        }
+
+        /// <summary>
+        /// Gets the greatest number of roots that can be added on top of the initial tree.
+        /// </summary>
+        /// <remarks>Each added root can create up to children() - 1 trees of sibling_depth()
+        /// levels, each allocating all its nodes at once: with the default SiblingDepth of
+        /// (at most) 4 that is 341 nodes for a quad tree and 4681 for an octree.</remarks>
+        constexpr static std::size_t max_levels()
+        {
+            return 32;
+        }
+
+        /// <summary>
+        /// Gets the number of roots added on top of the initial tree.
+        /// </summary>
+        std::size_t levels() const
+        {
+            return _levels.size();
+        }
+
+        /// <summary>
+        /// Gets the current bounds of the tree.
+        /// </summary>
+        TBounds get_bounds() const
+        {
+            return _levels.empty() ? _core.get_bounds() : _levels.back()->get_bounds();
+        }
+
+        /// <summary>
+        /// Gets the number of elements of the tree.
+        /// </summary>
+        std::size_t size() const
+        {
+            auto n = _core.size();
+
+            for (const auto& level : _levels)
+            {
+                n += level->size();
+            }
+
+            return n;
+        }
+
+        /// <summary>
+        /// Returns true only if the tree is empty, otherwise returns false.
+        /// </summary>
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        /// <summary>
+        /// Removes all the element from the tree, keeping its current bounds.
+        /// </summary>
+        void clear()
+        {
+            for (const auto& level : _levels)
+            {
+                level->clear();
+            }
+
+            _core.clear();
+        }
+
+        /// <summary>
+        /// Insert the given element into the tree, growing its bounds if they
+        /// cannot contain the element.
+        /// </summary>
+        /// <param name="element">Element to be inserted.</param>
+        /// <param name="bounds">Element bounds.</param>
+        /// <returns>Returns true only if the element has been inserted, otherwise returns
+        /// false (when the bounds cannot be reached within the maximum number of levels, or
+        /// by bounds that the coordinate type can represent).</returns>
+        bool insert(TElement element, TBounds bounds)
+        {
+            if (_core.contains(bounds))
+            {
+                return _core.insert(std::move(element), std::move(bounds));
+            }
+
+            for (const auto& level : _levels)
+            {
+                if (level->contains(bounds))
+                {
+                    return level->insert(std::move(element), std::move(bounds));
+                }
+            }
+
+            // none of the current roots contains the element: find the new roots
+            // needed before changing the tree, so that a failure leaves it untouched
+            std::vector<std::pair<TBounds, std::size_t>> roots;
+            auto root = get_bounds();
+
+            while (!root.contains(bounds))
+            {
+                std::pair<TBounds, std::size_t> grown;
+
+                if (_levels.size() + roots.size() == max_levels() || !TTraits::grow(root, bounds, grown))
+                {
+                    return false;
+                }
+
+                roots.push_back(grown);
+                root = roots.back().first;
+            }
+
+            for (const auto& r : roots)
+            {
+                _levels.emplace_back(new level(r.first, r.second));
+            }
+
+            return _levels.back()->insert(std::move(element), std::move(bounds));
+        }
+
+        /// <summary>
+        /// Removes the given element from the tree. The tree bounds never shrink.
+        /// </summary>
+        /// <param name="element">Element to be removed.</param>
+        /// <param name="bounds">Bounds the element was inserted with.</param>
+        /// <returns>Returns true only if the element has been removed,
+        /// otherwise returns false.</returns>
+        bool remove(const TElement& element, const TBounds& bounds)
+        {
+            if (_core.contains(bounds))
+            {
+                return _core.remove(element, bounds);
+            }
+
+            for (const auto& level : _levels)
+            {
+                if (level->contains(bounds))
+                {
+                    return level->remove(element, bounds);
+                }
+            }
+
+            return false;
+        }
+
+        /// <summary>
+        /// Gets all the elements of the tree.
+        /// </summary>
+        /// <param name="elements">References to the elements of this tree.</param>
+        void query(TElementRefContainer& elements) const
+        {
+            _core.query(elements);
+
+            for (const auto& level : _levels)
+            {
+                level->query(elements);
+            }
+        }
+
+        /// <summary>
+        /// Gets all the elements of the tree that intersect the given area.
+        /// </summary>
+        /// <param name="area">Area to overlaps.</param>
+        /// <param name="elements">References to the elements of this tree that intersect
+        /// the given area.</param>
+        void query(const TBounds& area, TElementRefContainer& elements) const
+        {
+            query(_core, area, elements);
+
+            for (const auto& level : _levels)
+            {
+                if (level->overlaps(area))
+                {
+                    level->query(area, elements);
+                }
+            }
+        }
+
+
+    private:
+
+        /// <summary>
+        /// Queries the given tree with the same cases used by the tree nodes.
+        /// </summary>
+        template<typename TSubtree>
+        static void query(const TSubtree& tree, const TBounds& area, TElementRefContainer& elements)
+        {
+            if (tree.inside(area))
+            {
+                tree.query(elements);
+            }
+            else if (tree.overlaps(area))
+            {
+                tree.query(area, elements);
+            }
+        }
+
+        /// <summary>
+        /// Root added on top of the previous one, which is its child in the inner location.
+        /// It holds the elements not contained by any of its children, and creates the
+        /// other children only when an element is inserted into them.
+        /// </summary>
+        class level : public TNode
+        {
+        public:
+
+            level(TBounds bounds, std::size_t inner)
+                : TNode(std::move(bounds))
+                , _inner(inner)
+            {
+            }
+
+            std::size_t size() const override
+            {
+                auto n = TNode::size();
+
+                for (const auto& child : _children)
+                {
+                    n += child ? child->size() : 0;
+                }
+
+                return n;
+            }
+
+            bool empty() const override
+            {
+                return size() == 0;
+            }
+
+            void clear() override
+            {
+                for (auto& child : _children)
+                {
+                    child.reset();
+                }
+
+                TNode::clear();
+            }
+
+            bool insert(TElement element, TBounds bounds) override
+            {
+                for (std::size_t i = 0; i < _children.size(); i++)
+                {
+                    if (i == _inner)
+                    {
+                        // already known to not contain the element
+                        continue;
+                    }
+
+                    auto& child = _children[i];
+                    const auto childBounds = child ? child->get_bounds() : TTraits::child(this->get_bounds(), i);
+
+                    if (childBounds.contains(bounds))
+                    {
+                        if (!child)
+                        {
+                            child.reset(new TSibling(childBounds));
+                        }
+
+                        return child->insert(std::move(element), std::move(bounds));
+                    }
+                }
+
+                return TNode::insert(std::move(element), std::move(bounds));
+            }
+
+            bool remove(const TElement& element, const TBounds& bounds)
+            {
+                for (const auto& child : _children)
+                {
+                    if (child && child->contains(bounds))
+                    {
+                        return child->remove(element, bounds);
+                    }
+                }
+
+                return TNode::remove(element, bounds);
+            }
+
+            void query(TElementRefContainer& elements) const override
+            {
+                for (const auto& child : _children)
+                {
+                    if (child)
+                    {
+                        child->query(elements);
+                    }
+                }
+
+                TNode::query(elements);
+            }
+
+            void query(const TBounds& area, TElementRefContainer& elements) const override
+            {
+                TNode::query(area, elements);
+
+                for (const auto& child : _children)
+                {
+                    if (child)
+                    {
+                        expanding_tree::query(*child, area, elements);
+                    }
+                }
+            }
+
+
+        private:
+
+            const std::size_t _inner;
+            std::array<std::unique_ptr<TSibling>, TTraits::children()> _children;
+        };
+
+        TTree _core;
+        std::vector<std::unique_ptr<level>> _levels;
+    };
+
+    /// <summary>
+    /// Quad tree whose bounds grow to contain the elements inserted outside of them.
+    /// </summary>
+    template<typename TElement, typename TCoordinate, std::size_t Depth,
+        std::size_t SiblingDepth = (Depth < 4 ? Depth : 4)>
+    using expanding_quadtree = expanding_tree<TElement, rect<TCoordinate>, Depth, SiblingDepth>;
+
+    /// <summary>
+    /// Octree whose bounds grow to contain the elements inserted outside of them.
+    /// </summary>
+    template<typename TElement, typename TCoordinate, std::size_t Depth,
+        std::size_t SiblingDepth = (Depth < 4 ? Depth : 4)>
+    using expanding_octree = expanding_tree<TElement, box<TCoordinate, 3>, Depth, SiblingDepth>;
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef QTREE_MORTON_H_
+#define QTREE_MORTON_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace qtree
+{
+    /// <summary>
+    /// Performs a single step of the bit interleaving.
+    /// </summary>
+    constexpr std::uint64_t morton_spread_step(std::uint64_t x, unsigned shift, std::uint64_t mask) noexcept
+    {
+        return (x | (x << shift)) & mask;
+    }
+
+    /// <summary>
+    /// Spreads the lower 32 bits of the given value so that a zero bit
+    /// is inserted between each pair of consecutive bits.
+    /// </summary>
+    constexpr std::uint64_t morton_spread(std::uint64_t x) noexcept
+    {
+        return morton_spread_step(
+            morton_spread_step(
+                morton_spread_step(
+                    morton_spread_step(
+                        morton_spread_step(x & 0x00000000FFFFFFFFull, 16, 0x0000FFFF0000FFFFull),
+                        8, 0x00FF00FF00FF00FFull),
+                    4, 0x0F0F0F0F0F0F0F0Full),
+                2, 0x3333333333333333ull),
+            1, 0x5555555555555555ull);
+    }
+
+    /// <summary>
+    /// Gets the Morton code (Z-order) of the given grid cell, where the bits of x
+    /// take the even positions and the bits of y take the odd positions.
+    /// </summary>
+    /// <param name="x">Column of the cell.</param>
+    /// <param name="y">Row of the cell.</param>
+    constexpr std::uint64_t morton_encode(std::uint32_t x, std::uint32_t y) noexcept
+    {
+        return morton_spread(x) | (morton_spread(y) << 1);
+    }
+
+    /// <summary>
+    /// Spreads the lower 21 bits of the given value so that two zero bits
+    /// are inserted between each pair of consecutive bits.
+    /// </summary>
+    constexpr std::uint64_t morton_spread3(std::uint64_t x) noexcept
+    {
+        return morton_spread_step(
+            morton_spread_step(
+                morton_spread_step(
+                    morton_spread_step(
+                        morton_spread_step(x & 0x00000000001FFFFFull, 32, 0x001F00000000FFFFull),
+                        16, 0x001F0000FF0000FFull),
+                    8, 0x100F00F00F00F00Full),
+                4, 0x10C30C30C30C30C3ull),
+            2, 0x1249249249249249ull);
+    }
+
+    /// <summary>
+    /// Gets the Morton code of the given 3D grid cell, where the bits of x, y
+    /// and z take respectively the positions 3k, 3k+1 and 3k+2.
+    /// </summary>
+    constexpr std::uint64_t morton_encode(std::uint32_t x, std::uint32_t y, std::uint32_t z) noexcept
+    {
+        return morton_spread3(x) | (morton_spread3(y) << 1) | (morton_spread3(z) << 2);
+    }
+
+    /// <summary>
+    /// Gets the Morton code of the given grid cell of any dimension, where the
+    /// k-th bit of the i-th coordinate takes the position k * N + i.
+    /// </summary>
+    template<std::size_t N>
+    std::uint64_t morton_encode(const std::array<std::uint32_t, N>& cell) noexcept
+    {
+        std::uint64_t code = 0;
+
+        // the coordinates have 32 bits, that are all used only with a single dimension
+        for (std::size_t bit = 0; bit < 32 && bit * N < 64; bit++)
+        {
+            for (std::size_t i = 0; i < N && bit * N + i < 64; i++)
+            {
+                code |= static_cast<std::uint64_t>((cell[i] >> bit) & 1) << (bit * N + i);
+            }
+        }
+
+        return code;
+    }
+
+    inline std::uint64_t morton_encode(const std::array<std::uint32_t, 2>& cell) noexcept
+    {
+        return morton_encode(cell[0], cell[1]);
+    }
+
+    inline std::uint64_t morton_encode(const std::array<std::uint32_t, 3>& cell) noexcept
+    {
+        return morton_encode(cell[0], cell[1], cell[2]);
+    }
+
+    /// <summary>
+    /// Gets the number of levels, starting from the root, shared by two
+    /// Morton codes whose XOR is the given value.
+    /// </summary>
+    /// <param name="diff">XOR of the two Morton codes.</param>
+    /// <param name="levels">Number of levels (groups of bits) of the codes.</param>
+    /// <param name="dimensions">Number of bits of each level.</param>
+    constexpr std::size_t morton_shared_levels(std::uint64_t diff, std::size_t levels, std::size_t dimensions = 2) noexcept
+    {
+        return diff == 0 ? levels : morton_shared_levels(diff >> dimensions, levels - 1, dimensions);
+    }
+
+    /// <summary>
+    /// Gets the index of the cell of the deepest level of a node that holds the given coordinate.
+    /// </summary>
+    /// <param name="value">Coordinate to locate.</param>
+    /// <param name="min">Lower bound of the node along the same axis.</param>
+    /// <param name="max">Upper bound of the node along the same axis.</param>
+    /// <param name="depth">Depth of the node.</param>
+    /// <param name="upper">Whether the coordinate is an upper bound, in which case
+    /// a value lying on the border of two cells belongs to the lower one.</param>
+    template<typename TCoordinate>
+    std::uint32_t morton_cell(TCoordinate value, TCoordinate min, TCoordinate max, std::size_t depth, bool upper)
+    {
+        const auto cells = static_cast<double>(std::uint64_t{1} << depth);
+        const auto extent = static_cast<double>(max) - static_cast<double>(min);
+
+        if (!(extent > 0))
+        {
+            return 0;
+        }
+
+        const auto offset = (static_cast<double>(value) - static_cast<double>(min)) / extent * cells;
+        const auto index = upper ? std::ceil(offset) - 1 : std::floor(offset);
+
+        return static_cast<std::uint32_t>(std::min(std::max(index, 0.0), cells - 1));
+    }
+}
+
+#endif
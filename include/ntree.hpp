@@ -0,0 +1,896 @@
+#ifndef QTREE_NTREE_H_
+#define QTREE_NTREE_H_
+
+#include "morton.hpp"
+#include "qaggregate.hpp"
+#include "qcontext.hpp"
+#include "qnode.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace qtree
+{
+    /// <summary>
+    /// Describes how a bounds type is partitioned by a tree node.
+    /// </summary>
+    /// <remarks>Each specialization must provide the following members.
+    /// coordinate: the coordinate type.
+    /// dimensions(): the number of dimensions.
+    /// children(): the number of children of each node.
+    /// child&lt;Location&gt;(parent): the bounds of the child in a location known at compile time.
+    /// child(parent, location): the bounds of the child in a location known at run time.
+    /// morton_child(bits): the location of the child addressed by a group of Morton code bits.
+    /// locate(node, bounds, depth): the Morton code of the bounds, with the number of levels to go
+    /// down to reach the deepest node that completely contains them.
+    /// The following members are optional, required only by the features using them.
+    /// grow(node, bounds, grown): sets grown to the bounds of a parent of the node extended towards
+    /// the given bounds, with the location of the node inside it, and returns false if they cannot
+    /// be represented by the coordinate type (expanding_tree).
+    /// vector: the type of the velocities (ntree::sweep).
+    /// sweep(bounds, velocity, target, duration, time): the earliest time when the bounds moving
+    /// with the velocity overlap the target ones during the time step (ntree::sweep).</remarks>
+    template<typename TBounds>
+    struct bounds_traits;
+
+    /// <summary>
+    /// Moves a coordinate of a node away from the node by the node extent along the same axis,
+    /// as done when a parent twice as large is added on top of the node.
+    /// </summary>
+    /// <param name="lower">Lower coordinate of the node.</param>
+    /// <param name="upper">Upper coordinate of the node.</param>
+    /// <param name="down">Whether the lower coordinate is moved down, otherwise the upper one is moved up.</param>
+    /// <param name="result">Moved coordinate, set only on success.</param>
+    /// <returns>Returns true only if the extent and the moved coordinate can be represented by the
+    /// coordinate type, otherwise returns false.</returns>
+    template<typename TCoordinate>
+    bool grow_coordinate(TCoordinate lower, TCoordinate upper, bool down, TCoordinate& result)
+    {
+        using TLimits = std::numeric_limits<TCoordinate>;
+
+        if (lower < TCoordinate{} && upper > TLimits::max() + lower)
+        {
+            return false;
+        }
+
+        const auto extent = upper - lower;
+
+        if (down ? lower < TLimits::lowest() + extent : upper > TLimits::max() - extent)
+        {
+            return false;
+        }
+
+        result = down ? lower - extent : upper + extent;
+        return true;
+    }
+
+    /// <summary>
+    /// Adds to the given hits the elements of the given node overlapped by the given
+    /// bounds while they move with the given velocity during the time step.
+    /// </summary>
+    template<typename TElement, typename TCoordinate, typename TBounds>
+    void sweep_elements(const qnode<TElement, TCoordinate, TBounds>& node, const TBounds& bounds,
+        const typename bounds_traits<TBounds>::vector& velocity, double duration,
+        typename qnode<TElement, TCoordinate, TBounds>::TElementHitContainer& hits)
+    {
+        node.for_each_element([&](const TElement& element, const TBounds& elementBounds)
+        {
+            QTREE_STATS_ADD(elements_tested, 1);
+            double time;
+
+            if (bounds_traits<TBounds>::sweep(bounds, velocity, elementBounds, duration, time))
+            {
+                hits.emplace_back(const_cast<TElement&>(element), time);
+                QTREE_STATS_ADD(elements_returned, 1);
+            }
+        });
+    }
+
+    /// <summary>
+    /// Tree that recursively partitions the space of its bounds into 2^N children for each
+    /// node, where N is the number of dimensions of the bounds (quadtree and octree).
+    /// </summary>
+    /// <remarks>If an aggregate is given (see count_aggregate), each node keeps the summary
+    /// of its elements and of the elements of its children. If Epochs is true, each node
+    /// keeps the id and the epoch needed to query the tree through a qcontext.</remarks>
+    template<typename TElement, typename TBounds, std::size_t Depth, typename TAggregate = void, bool Epochs = false>
+    class ntree
+        : public qnode<TElement, typename bounds_traits<TBounds>::coordinate, TBounds>
+        , public aggregate_node<TAggregate>
+        , public epoch_node<Epochs>
+    {
+        /// The parent node can access these private members.
+        friend class ntree<TElement, TBounds, Depth + 1, TAggregate, Epochs>;
+
+        using TTraits = bounds_traits<TBounds>;
+        using TNode = qnode<TElement, typename TTraits::coordinate, TBounds>;
+        using TSummary = typename aggregate_node<TAggregate>::TSummary;
+
+        /// This node children will be created in the heap store (in order to avoid
+        /// possible stack overflow for high levels of depth).
+        using TNodePtr = std::unique_ptr<ntree<TElement, TBounds, Depth - 1, TAggregate, Epochs>>;
+
+        /// The cells of the deepest level are addressed by 64 bits Morton codes.
+        static_assert(Depth * TTraits::dimensions() <= 64, "The tree depth is too high for the Morton codes.");
+
+
+    public:
+
+        /// <summary>
+        /// Initializes the instance with the given bounds.
+        /// </summary>
+        /// <param name="bounds">Tree bounds.</param>
+        explicit ntree(TBounds bounds)
+            : TNode(std::move(bounds))
+        {
+            init_children(std::integral_constant<std::size_t, 0>());
+        }
+
+        /// <summary>
+        /// Gets the node depth.
+        /// </summary>
+        constexpr static std::size_t depth()
+        {
+            return Depth;
+        }
+
+        /// <summary>
+        /// Gets the number of elements belonging to this node
+        /// and to all is children nodes.
+        /// </summary>
+        std::size_t size() const override
+        {
+            auto n = TNode::size();
+
+            for (const auto& child : _children)
+            {
+                n += child->size();
+            }
+
+            return n;
+        }
+
+        /// <summary>
+        /// Returns true only if this node is empty and all of its
+        /// children are empty, otherwise returns false.
+        /// </summary>
+        bool empty() const override
+        {
+            return size() == 0;
+        }
+
+        /// <summary>
+        /// Removes all the element from the tree.
+        /// </summary>
+        void clear() override
+        {
+            for (const auto& child : _children)
+            {
+                child->clear();
+            }
+
+            TNode::clear();
+            this->aggregate_clear();
+            this->touch();
+        }
+
+        /// <summary>
+        /// Insert the given element into the tree.
+        /// </summary>
+        /// <param name="element">Element to be inserted.</param>
+        /// <param name="bounds">Element bounds.</param>
+        /// <returns>Returns true only if the element has been inserted,
+        /// otherwise returns false.</returns>
+        bool insert(TElement element, TBounds bounds) override
+        {
+            if (!this->contains(bounds))
+            {
+                // the given element cannot be contained by this node
+                return false;
+            }
+
+            QTREE_STATS_ADD(inserts, 1);
+
+            // jump straight to the deepest node that completely contains the item
+            const auto location = locate(bounds);
+            const auto value = this->aggregate_value(element, bounds);
+
+            if (insert_at(element, bounds, value, location.first, location.second))
+            {
+                return true;
+            }
+
+            // rounding errors may cause the addressed node to not contain the item:
+            // fall back to testing the children bounds level by level.
+            QTREE_STATS_ADD(insert_fallbacks, 1);
+            return insert_descend(std::move(element), std::move(bounds), value);
+        }
+
+        /// <summary>
+        /// Removes the given element from the tree.
+        /// </summary>
+        /// <param name="element">Element to be removed.</param>
+        /// <param name="bounds">Bounds the element was inserted with.</param>
+        /// <returns>Returns true only if the element has been removed,
+        /// otherwise returns false.</returns>
+        bool remove(const TElement& element, const TBounds& bounds)
+        {
+            if (!this->contains(bounds))
+            {
+                return false;
+            }
+
+            QTREE_STATS_ADD(removes, 1);
+
+            // the element is stored in the same node insert jumped to
+            const auto location = locate(bounds);
+            bool addressed = false;
+            const auto removed = remove_at(element, bounds, location.first, location.second, addressed);
+
+            if (addressed)
+            {
+                return removed;
+            }
+
+            QTREE_STATS_ADD(insert_fallbacks, 1);
+            return remove_descend(element, bounds);
+        }
+
+        /// <summary>
+        /// Gets all the elements of the tree.
+        /// </summary>
+        /// <param name="elements">References to the elements of this tree.</param>
+        void query(typename TNode::TElementRefContainer& elements) const override
+        {
+            for (const auto& child : _children)
+            {
+                child->query(elements);
+            }
+
+            TNode::query(elements);
+        }
+
+        /// <summary>
+        /// Gets all the elements of the node that intersect the given area.
+        /// </summary>
+        /// <param name="area">Area to overlaps.</param>
+        /// <param name="elements">References to the elements of this node that intersect
+        /// the given area.</param>
+        void query(const TBounds& area, typename TNode::TElementRefContainer& elements) const override
+        {
+            // this node may contain items that are not entirely contained by its children
+            TNode::query(area, elements);
+
+            for (const auto& child : _children)
+            {
+                // case 1: search area completely contained by child node
+                // if a node completely contains the query area, go down that branch
+                // and skip the remaining nodes
+                if (child->contains(area))
+                {
+                    child->query(area, elements);
+                    break;
+                }
+
+                // case 2: Child node completely contained by search area
+                // if the query area completely contains a child node,
+                // add all the contents of that node and its children.
+                if (child->inside(area))
+                {
+                    child->query(elements);
+                    continue;
+                }
+
+                // case 3: search area overlaps with child node
+                // traverse into this node, continue the loop to search other nodes
+                if (child->overlaps(area))
+                {
+                    child->query(area, elements);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Gets all the elements of the tree that intersect the given area, like
+        /// query(area, elements), reusing the results of the previous query made with the
+        /// same context for the nodes that did not change since. Available only if the
+        /// tree has epochs.
+        /// </summary>
+        /// <param name="area">Area to overlaps.</param>
+        /// <param name="elements">References to the elements of this tree that intersect
+        /// the given area.</param>
+        /// <param name="context">Context of the previous queries of this tree.</param>
+        void query(const TBounds& area, typename TNode::TElementRefContainer& elements,
+            qcontext<TElement, TBounds>& context) const
+        {
+            static_assert(Epochs, "The tree has no epochs.");
+            context.begin(this->id(), area);
+
+            if (context.reuse_all(this->epoch(), elements))
+            {
+                return;
+            }
+
+            // start from the deepest node that completely contains the area,
+            // already known if the area did not change
+            const auto first = elements.size();
+            auto location = context._location;
+
+            if (!context._same)
+            {
+                location = this->contains(area) ? locate(area) : std::make_pair(std::uint64_t{0}, std::size_t{0});
+            }
+
+            query_path(area, elements, context, location.first, location.second);
+            context.end(area, location, this->epoch(), elements, first);
+        }
+
+        /// <summary>
+        /// Gets the elements overlapped by the given bounds while they move with the given
+        /// velocity during the time step, each one with the earliest time of impact, sorted
+        /// by time. The nodes never overlapped during the time step are skipped.
+        /// </summary>
+        /// <param name="bounds">Moving bounds at time zero.</param>
+        /// <param name="velocity">Velocity of the bounds.</param>
+        /// <param name="duration">Duration of the time step.</param>
+        /// <param name="hits">References to the elements hit during the time step, with their
+        /// time of impact (zero for the elements already overlapped at the beginning).</param>
+        /// <remarks>Requires the bounds traits to provide vector and sweep (the traits are a
+        /// template parameter only to look them up when this member is used).</remarks>
+        template<typename TSweepTraits = TTraits, typename TVector = typename TSweepTraits::vector>
+        void sweep(const TBounds& bounds, const TVector& velocity, double duration,
+            typename TNode::TElementHitContainer& hits) const
+        {
+            const auto first = hits.size();
+            sweep_nodes(bounds, velocity, duration, hits);
+
+            std::stable_sort(hits.begin() + first, hits.end(),
+                [](const typename TNode::TElementHitContainer::value_type& lhs,
+                    const typename TNode::TElementHitContainer::value_type& rhs)
+                {
+                    return lhs.second < rhs.second;
+                });
+        }
+
+        /// <summary>
+        /// Gets the summary of the elements that intersect the given area, according to
+        /// the tree aggregate. The summaries of the nodes completely contained by the
+        /// area are used as a whole, so that only the elements of the nodes crossing
+        /// its border are tested (the same elements returned by query(area, elements)).
+        /// </summary>
+        /// <param name="area">Area to overlaps.</param>
+        TSummary aggregate(const TBounds& area) const
+        {
+            static_assert(!std::is_void<TAggregate>::value, "The tree has no aggregate.");
+
+            auto summary = TAggregate::identity();
+            aggregate(area, summary);
+            return summary;
+        }
+
+        /// <summary>
+        /// Gets a snapshot of the shape of the tree.
+        /// </summary>
+        qstats stats() const
+        {
+            qstats stats;
+            stats.level_elements.assign(Depth + 1, 0);
+
+            visit([&stats](const TNode& node, std::size_t depth)
+            {
+                std::size_t count = 0;
+                node.for_each_element([&count](const TElement&, const TBounds&) { ++count; });
+
+                stats.nodes++;
+                stats.empty_nodes += count == 0 ? 1 : 0;
+                stats.elements += count;
+                stats.max_bucket = std::max(stats.max_bucket, count);
+                stats.level_elements[Depth - depth] += count;
+            });
+
+            return stats;
+        }
+
+        /// <summary>
+        /// Visits this node and all of its children in depth-first pre-order, where the
+        /// children are visited in the order of their locations (for a quad tree: North-West,
+        /// North-East, South-East, South-West).
+        /// </summary>
+        /// <param name="visitor">Function invoked as visitor(node, depth), where depth
+        /// is the depth of the visited node.</param>
+        template<typename TVisitor>
+        void visit(TVisitor&& visitor) const
+        {
+            visitor(static_cast<const TNode&>(*this), Depth);
+
+            for (const auto& child : _children)
+            {
+                child->visit(visitor);
+            }
+        }
+
+
+    private:
+
+        /// <summary>
+        /// Gets the Morton code of the first cell of the deepest level covered by the
+        /// given bounds, and the number of levels to go down to reach the deepest node
+        /// that completely contains them.
+        /// </summary>
+        std::pair<std::uint64_t, std::size_t> locate(const TBounds& bounds) const
+        {
+            return TTraits::locate(this->get_bounds(), bounds, Depth);
+        }
+
+        /// <summary>
+        /// Gets the child node addressed by the given Morton code.
+        /// </summary>
+        const TNodePtr& child_at(std::uint64_t code) const
+        {
+            const auto bits = (code >> (TTraits::dimensions() * (Depth - 1))) & (TTraits::children() - 1);
+            return _children[TTraits::morton_child(bits)];
+        }
+
+        /// <summary>
+        /// Insert the given element into the node addressed by the given Morton code.
+        /// </summary>
+        /// <param name="element">Element to be inserted, moved only on success.</param>
+        /// <param name="bounds">Element bounds, moved only on success.</param>
+        /// <param name="value">Summary of the element, added to the nodes on the path.</param>
+        /// <param name="code">Morton code of the cell of the deepest level.</param>
+        /// <param name="levels">Number of levels to go down before reaching the node.</param>
+        /// <returns>Returns true only if the addressed node contained the element,
+        /// otherwise returns false.</returns>
+        bool insert_at(TElement& element, TBounds& bounds, const TSummary& value,
+            std::uint64_t code, std::size_t levels)
+        {
+            if (levels == 0)
+            {
+                // the Morton cells may not match the children borders (such as the rounded
+                // ones of integer coordinates): keep going down from the addressed node
+                return this->contains(bounds) && insert_descend(std::move(element), std::move(bounds), value);
+            }
+
+            QTREE_STATS_ADD(insert_nodes, 1);
+
+            if (!child_at(code)->insert_at(element, bounds, value, code, levels - 1))
+            {
+                return false;
+            }
+
+            this->aggregate_insert(value);
+            this->touch();
+            return true;
+        }
+
+        /// <summary>
+        /// Insert the given element into the first child that completely contains it,
+        /// or into this node if none of them does.
+        /// </summary>
+        bool insert_descend(TElement element, TBounds bounds, const TSummary& value)
+        {
+            QTREE_STATS_ADD(insert_nodes, 1);
+
+            auto inserted = false;
+            auto descended = false;
+
+            for (const auto& child : _children)
+            {
+                if (child->contains(bounds))
+                {
+                    inserted = child->insert_descend(std::move(element), std::move(bounds), value);
+                    descended = true;
+                    break;
+                }
+            }
+
+            if (!descended)
+            {
+                // at this point none of the children completely contained the item.
+                // add the element to this node.
+                inserted = TNode::insert(std::move(element), std::move(bounds));
+            }
+
+            if (inserted)
+            {
+                if (descended)
+                {
+                    this->aggregate_insert(value);
+                }
+                else
+                {
+                    this->aggregate_insert_own(value);
+                }
+
+                this->touch();
+            }
+
+            return inserted;
+        }
+
+        /// <summary>
+        /// Removes the given element from the node addressed by the given Morton code.
+        /// </summary>
+        /// <param name="addressed">Set to true only if the addressed node contains
+        /// the element bounds.</param>
+        bool remove_at(const TElement& element, const TBounds& bounds,
+            std::uint64_t code, std::size_t levels, bool& addressed)
+        {
+            if (levels == 0)
+            {
+                // the element was inserted going down from the addressed node
+                addressed = this->contains(bounds);
+                return addressed && remove_descend(element, bounds);
+            }
+
+            QTREE_STATS_ADD(insert_nodes, 1);
+
+            const auto removed = child_at(code)->remove_at(element, bounds, code, levels - 1, addressed);
+
+            if (removed)
+            {
+                // the elements of this node did not change
+                this->aggregate_combine(_children);
+                this->touch();
+            }
+
+            return removed;
+        }
+
+        /// <summary>
+        /// Removes the given element from the first child that completely contains it,
+        /// or from this node if none of them does.
+        /// </summary>
+        bool remove_descend(const TElement& element, const TBounds& bounds)
+        {
+            QTREE_STATS_ADD(insert_nodes, 1);
+
+            auto removed = false;
+            auto descended = false;
+
+            for (const auto& child : _children)
+            {
+                if (child->contains(bounds))
+                {
+                    removed = child->remove_descend(element, bounds);
+                    descended = true;
+                    break;
+                }
+            }
+
+            if (!descended)
+            {
+                removed = TNode::remove(element, bounds);
+            }
+
+            if (removed)
+            {
+                // only the node the element left scans its elements again
+                if (descended)
+                {
+                    this->aggregate_combine(_children);
+                }
+                else
+                {
+                    this->aggregate_update(*this, _children);
+                }
+
+                this->touch();
+            }
+
+            return removed;
+        }
+
+        /// <summary>
+        /// Gets the elements of the nodes on the path to the node addressed by the given
+        /// Morton code that intersect the given area, then queries that node.
+        /// </summary>
+        void query_path(const TBounds& area, typename TNode::TElementRefContainer& elements,
+            qcontext<TElement, TBounds>& context, std::uint64_t code, std::size_t levels) const
+        {
+            if (levels > 0)
+            {
+                const auto& child = child_at(code);
+
+                // rounding errors may cause the addressed node to not contain the area:
+                // start from this node instead
+                if (child->contains(area))
+                {
+                    TNode::query(area, elements);
+                    child->query_path(area, elements, context, code, levels - 1);
+                    return;
+                }
+            }
+
+            if (context.reuse_start(this->id(), this->epoch(), elements))
+            {
+                return;
+            }
+
+            const auto first = elements.size();
+            query_cached(area, elements, context);
+            context.store_start(this->id(), this->epoch(), elements, first);
+        }
+
+        /// <summary>
+        /// Gets all the elements of this node and of its children that intersect the given
+        /// area, reusing the cached results of the children completely contained by the area.
+        /// </summary>
+        void query_cached(const TBounds& area, typename TNode::TElementRefContainer& elements,
+            qcontext<TElement, TBounds>& context) const
+        {
+            TNode::query(area, elements);
+
+            for (const auto& child : _children)
+            {
+                // same cases of query(area, elements)
+                if (child->contains(area))
+                {
+                    child->query_cached(area, elements, context);
+                    break;
+                }
+
+                if (child->inside(area))
+                {
+                    if (!context.reuse_subtree(child->id(), child->epoch(), elements))
+                    {
+                        const auto first = elements.size();
+                        child->query(elements);
+                        context.store_subtree(child->id(), child->epoch(), elements, first);
+                    }
+
+                    continue;
+                }
+
+                if (child->overlaps(area))
+                {
+                    child->query_cached(area, elements, context);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Adds to the given hits the elements of this node and of its children overlapped
+        /// by the moving bounds during the time step.
+        /// </summary>
+        template<typename TVector>
+        void sweep_nodes(const TBounds& bounds, const TVector& velocity, double duration,
+            typename TNode::TElementHitContainer& hits) const
+        {
+            QTREE_STATS_ADD(query_nodes, 1);
+            double time;
+
+            // the elements are contained by the node: if the node is never overlapped,
+            // none of them is
+            if (!TTraits::sweep(bounds, velocity, this->get_bounds(), duration, time))
+            {
+                return;
+            }
+
+            sweep_elements(*this, bounds, velocity, duration, hits);
+
+            for (const auto& child : _children)
+            {
+                child->sweep_nodes(bounds, velocity, duration, hits);
+            }
+        }
+
+        /// <summary>
+        /// Adds to the given summary the elements of this node and of its children
+        /// that intersect the given area, with the same cases used by query.
+        /// </summary>
+        void aggregate(const TBounds& area, TSummary& summary) const
+        {
+            QTREE_STATS_ADD(query_nodes, 1);
+            this->aggregate_overlapping(*this, area, summary);
+
+            for (const auto& child : _children)
+            {
+                if (child->contains(area))
+                {
+                    child->aggregate(area, summary);
+                    break;
+                }
+
+                if (child->inside(area))
+                {
+                    summary = TAggregate::combine(summary, child->summary());
+                    continue;
+                }
+
+                if (child->overlaps(area))
+                {
+                    child->aggregate(area, summary);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Initializes the children nodes starting from the given location, according
+        /// to the tree depth (unrolled at compile time).
+        /// </summary>
+        template<std::size_t Location>
+        void init_children(std::integral_constant<std::size_t, Location>)
+        {
+            _children[Location].reset(
+                new ntree<TElement, TBounds, Depth - 1, TAggregate, Epochs>(TTraits::template child<Location>(this->get_bounds())));
+
+            init_children(std::integral_constant<std::size_t, Location + 1>());
+        }
+
+        /// <summary>
+        /// Ends the initialization of the children nodes.
+        /// </summary>
+        void init_children(std::integral_constant<std::size_t, TTraits::children()>)
+        {
+        }
+
+        std::array<TNodePtr, TTraits::children()> _children;
+    };
+
+    /* ntree template specialization for Depth 0. */
+    template<typename TElement, typename TBounds, typename TAggregate, bool Epochs>
+    class ntree<TElement, TBounds, 0, TAggregate, Epochs>
+        : public qnode<TElement, typename bounds_traits<TBounds>::coordinate, TBounds>
+        , public aggregate_node<TAggregate>
+        , public epoch_node<Epochs>
+    {
+        /// The parent node can access these private members.
+        friend class ntree<TElement, TBounds, 1, TAggregate, Epochs>;
+
+        using TNode = qnode<TElement, typename bounds_traits<TBounds>::coordinate, TBounds>;
+        using TSummary = typename aggregate_node<TAggregate>::TSummary;
+
+        /// <summary>
+        /// Initializes the instance with the given bounds.
+        /// </summary>
+        /// <param name="bounds">Tree bounds.</param>
+        constexpr explicit ntree(TBounds bounds)
+            : TNode(std::move(bounds))
+        {
+        }
+
+        /// <summary>
+        /// Visits this node, that is the deepest one.
+        /// </summary>
+        template<typename TVisitor>
+        void visit(TVisitor&& visitor) const
+        {
+            visitor(static_cast<const TNode&>(*this), std::size_t{0});
+        }
+
+        /// <summary>
+        /// Insert the given element into this node, that is the deepest one.
+        /// </summary>
+        bool insert_at(TElement& element, TBounds& bounds, const TSummary& value, std::uint64_t, std::size_t)
+        {
+            QTREE_STATS_ADD(insert_nodes, 1);
+
+            return this->contains(bounds)
+                && insert(std::move(element), std::move(bounds), value);
+        }
+
+        /// <summary>
+        /// Insert the given element into this node, that is the deepest one.
+        /// </summary>
+        bool insert_descend(TElement element, TBounds bounds, const TSummary& value)
+        {
+            QTREE_STATS_ADD(insert_nodes, 1);
+
+            return insert(std::move(element), std::move(bounds), value);
+        }
+
+        /// <summary>
+        /// Insert the given element into this node, adding its summary.
+        /// </summary>
+        bool insert(TElement element, TBounds bounds, const TSummary& value)
+        {
+            if (!TNode::insert(std::move(element), std::move(bounds)))
+            {
+                return false;
+            }
+
+            this->aggregate_insert_own(value);
+            this->touch();
+            return true;
+        }
+
+        /// <summary>
+        /// Removes the given element from this node, that is the deepest one.
+        /// </summary>
+        bool remove_at(const TElement& element, const TBounds& bounds,
+            std::uint64_t, std::size_t, bool& addressed)
+        {
+            QTREE_STATS_ADD(insert_nodes, 1);
+
+            addressed = this->contains(bounds);
+            return addressed && remove(element, bounds);
+        }
+
+        /// <summary>
+        /// Removes the given element from this node, that is the deepest one.
+        /// </summary>
+        bool remove_descend(const TElement& element, const TBounds& bounds)
+        {
+            QTREE_STATS_ADD(insert_nodes, 1);
+
+            return remove(element, bounds);
+        }
+
+        /// <summary>
+        /// Removes the given element from this node, updating its summary.
+        /// </summary>
+        bool remove(const TElement& element, const TBounds& bounds)
+        {
+            if (!TNode::remove(element, bounds))
+            {
+                return false;
+            }
+
+            this->aggregate_update(*this);
+            this->touch();
+            return true;
+        }
+
+        /// <summary>
+        /// Removes all the element from this node, resetting its summary.
+        /// </summary>
+        void clear() override
+        {
+            TNode::clear();
+            this->aggregate_clear();
+            this->touch();
+        }
+
+        /// <summary>
+        /// Gets the elements of this node, that is the deepest one, that intersect the given area.
+        /// </summary>
+        void query_path(const TBounds& area, typename TNode::TElementRefContainer& elements,
+            qcontext<TElement, TBounds>&, std::uint64_t, std::size_t) const
+        {
+            TNode::query(area, elements);
+        }
+
+        /// <summary>
+        /// Gets the elements of this node, that is the deepest one, that intersect the given area.
+        /// </summary>
+        void query_cached(const TBounds& area, typename TNode::TElementRefContainer& elements,
+            qcontext<TElement, TBounds>&) const
+        {
+            TNode::query(area, elements);
+        }
+
+        /// <summary>
+        /// Adds to the given hits the elements of this node overlapped by the moving bounds
+        /// during the time step.
+        /// </summary>
+        template<typename TVector>
+        void sweep_nodes(const TBounds& bounds, const TVector& velocity, double duration,
+            typename TNode::TElementHitContainer& hits) const
+        {
+            QTREE_STATS_ADD(query_nodes, 1);
+            double time;
+
+            if (bounds_traits<TBounds>::sweep(bounds, velocity, this->get_bounds(), duration, time))
+            {
+                sweep_elements(*this, bounds, velocity, duration, hits);
+            }
+        }
+
+        /// <summary>
+        /// Adds to the given summary the elements of this node that intersect the given area.
+        /// </summary>
+        void aggregate(const TBounds& area, TSummary& summary) const
+        {
+            QTREE_STATS_ADD(query_nodes, 1);
+            this->aggregate_overlapping(*this, area, summary);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef QTREE_OCTREE_H_
+#define QTREE_OCTREE_H_
+
+#include "box.hpp"
+#include "morton.hpp"
+#include "ntree.hpp"
+#include "sweep.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace qtree
+{
+    /// <summary>
+    /// Splits the given parent bounds in half along the dimensions starting from the
+    /// given one, keeping the upper half only along the dimensions whose bit is set in
+    /// the child location (unrolled at compile time).
+    /// </summary>
+    template<typename TCoordinate, std::size_t N, std::size_t Location, std::size_t I>
+    void split_bounds(const box<TCoordinate, N>& parentBounds, box<TCoordinate, N>& bounds,
+        std::integral_constant<std::size_t, I>)
+    {
+        const auto half = parentBounds.lower[I] + (parentBounds.upper[I] - parentBounds.lower[I]) / static_cast<TCoordinate>(2);
+
+        if (Location & (std::size_t{1} << I))
+        {
+            bounds.lower[I] = half;
+            bounds.upper[I] = parentBounds.upper[I];
+        }
+        else
+        {
+            bounds.lower[I] = parentBounds.lower[I];
+            bounds.upper[I] = half;
+        }
+
+        split_bounds<TCoordinate, N, Location>(parentBounds, bounds, std::integral_constant<std::size_t, I + 1>());
+    }
+
+    template<typename TCoordinate, std::size_t N, std::size_t Location>
+    void split_bounds(const box<TCoordinate, N>&, box<TCoordinate, N>&, std::integral_constant<std::size_t, N>)
+    {
+    }
+
+    /// <summary>
+    /// Gets the bounds of a tree child node in the given location, where the i-th bit of the
+    /// location is set only if the child is in the upper half of the i-th dimension.
+    /// </summary>
+    /// <param name="parentBounds">Bounds of the parent tree node.</param>
+    template<typename TCoordinate, std::size_t N, std::size_t Location>
+    box<TCoordinate, N> child_bounds(const box<TCoordinate, N>& parentBounds)
+    {
+        static_assert(Location < (std::size_t{1} << N), "Invalid child location.");
+
+        box<TCoordinate, N> bounds;
+        split_bounds<TCoordinate, N, Location>(parentBounds, bounds, std::integral_constant<std::size_t, 0>());
+        return bounds;
+    }
+
+    /// <summary>
+    /// Gets the bounds of a tree child node in the given location, known only at run time.
+    /// </summary>
+    /// <param name="parentBounds">Bounds of the parent tree node.</param>
+    /// <param name="location">Location of the child node.</param>
+    template<typename TCoordinate, std::size_t N>
+    box<TCoordinate, N> child_bounds(const box<TCoordinate, N>& parentBounds, std::size_t location)
+    {
+        box<TCoordinate, N> bounds;
+
+        for (std::size_t i = 0; i < N; i++)
+        {
+            const auto half = parentBounds.lower[i] + (parentBounds.upper[i] - parentBounds.lower[i]) / static_cast<TCoordinate>(2);
+            const bool upper = (location & (std::size_t{1} << i)) != 0;
+
+            bounds.lower[i] = upper ? half : parentBounds.lower[i];
+            bounds.upper[i] = upper ? parentBounds.upper[i] : half;
+        }
+
+        return bounds;
+    }
+
+    /// <summary>
+    /// Gets the Morton code of the lower cell of the deepest level covered by the
+    /// given bounds, and the number of levels to go down from the given node to reach
+    /// the deepest node that completely contains them (computed from the XOR of the
+    /// Morton codes of the bounds corners).
+    /// </summary>
+    /// <param name="node">Bounds of the node, that must contain the given bounds.</param>
+    /// <param name="bounds">Bounds to locate.</param>
+    /// <param name="depth">Depth of the node.</param>
+    template<typename TCoordinate, std::size_t N>
+    std::pair<std::uint64_t, std::size_t> morton_locate(const box<TCoordinate, N>& node,
+        const box<TCoordinate, N>& bounds, std::size_t depth)
+    {
+        std::array<std::uint32_t, N> lower;
+        std::array<std::uint32_t, N> upper;
+
+        for (std::size_t i = 0; i < N; i++)
+        {
+            upper[i] = morton_cell(bounds.upper[i], node.lower[i], node.upper[i], depth, true);
+            // degenerate bounds lying on a cells border belong to the lower one
+            lower[i] = std::min(morton_cell(bounds.lower[i], node.lower[i], node.upper[i], depth, false), upper[i]);
+        }
+
+        const auto code = morton_encode(lower);
+        return std::make_pair(code, morton_shared_levels(code ^ morton_encode(upper), depth, N));
+    }
+
+    /// <summary>
+    /// Gets the bounds of a new tree root, twice as large as the given node along each
+    /// dimension and extended towards the given bounds, together with the location of
+    /// the node inside the new root.
+    /// </summary>
+    /// <param name="node">Bounds of the current root.</param>
+    /// <param name="bounds">Bounds the new root has to get closer to.</param>
+    /// <param name="grown">Bounds of the new root and location of the node, set only on success.</param>
+    /// <returns>Returns true only if the bounds of the new root can be represented by the
+    /// coordinate type, otherwise returns false.</returns>
+    template<typename TCoordinate, std::size_t N>
+    bool grow_bounds(const box<TCoordinate, N>& node, const box<TCoordinate, N>& bounds,
+        std::pair<box<TCoordinate, N>, std::size_t>& grown)
+    {
+        auto root = node;
+        std::size_t location = 0;
+
+        for (std::size_t i = 0; i < N; i++)
+        {
+            // the node becomes the upper half when the bounds are below it
+            const bool down = bounds.lower[i] < node.lower[i];
+
+            if (!grow_coordinate(node.lower[i], node.upper[i], down, down ? root.lower[i] : root.upper[i]))
+            {
+                return false;
+            }
+
+            location |= down ? std::size_t{1} << i : 0;
+        }
+
+        grown = std::make_pair(root, location);
+        return true;
+    }
+
+    /// <summary>
+    /// Gets the earliest time when the given moving bounds overlap the target ones
+    /// during the time step.
+    /// </summary>
+    /// <param name="bounds">Moving bounds at time zero.</param>
+    /// <param name="velocity">Velocity of the bounds along each dimension.</param>
+    /// <param name="target">Fixed bounds.</param>
+    /// <param name="duration">Duration of the time step.</param>
+    /// <param name="time">Earliest time of impact, set only on success.</param>
+    /// <returns>Returns true only if the bounds overlap during the time step,
+    /// otherwise returns false.</returns>
+    template<typename TCoordinate, std::size_t N>
+    bool sweep_bounds(const box<TCoordinate, N>& bounds, const std::array<TCoordinate, N>& velocity,
+        const box<TCoordinate, N>& target, double duration, double& time)
+    {
+        auto interval = sweep_unbounded();
+
+        for (std::size_t i = 0; i < N; i++)
+        {
+            if (!sweep_axis(bounds.lower[i], bounds.upper[i], velocity[i], target.lower[i], target.upper[i], interval))
+            {
+                return false;
+            }
+        }
+
+        return sweep_time(interval, duration, time);
+    }
+
+    /// <summary>
+    /// Partitioning of the N-dimensional boxes by the tree nodes.
+    /// </summary>
+    template<typename TCoordinate, std::size_t N>
+    struct bounds_traits<box<TCoordinate, N>>
+    {
+        using coordinate = TCoordinate;
+        using vector = std::array<TCoordinate, N>;
+
+        constexpr static std::size_t dimensions() { return N; }
+        constexpr static std::size_t children() { return std::size_t{1} << N; }
+
+        template<std::size_t Location>
+        static box<TCoordinate, N> child(const box<TCoordinate, N>& parentBounds)
+        {
+            return child_bounds<TCoordinate, N, Location>(parentBounds);
+        }
+
+        static box<TCoordinate, N> child(const box<TCoordinate, N>& parentBounds, std::size_t location)
+        {
+            return child_bounds(parentBounds, location);
+        }
+
+        /// The bit of each dimension has the same position in the
+        /// Morton codes and in the child location.
+        static std::size_t morton_child(std::uint64_t bits)
+        {
+            return static_cast<std::size_t>(bits);
+        }
+
+        static std::pair<std::uint64_t, std::size_t> locate(const box<TCoordinate, N>& node,
+            const box<TCoordinate, N>& bounds, std::size_t depth)
+        {
+            return morton_locate(node, bounds, depth);
+        }
+
+        static bool grow(const box<TCoordinate, N>& node, const box<TCoordinate, N>& bounds,
+            std::pair<box<TCoordinate, N>, std::size_t>& grown)
+        {
+            return grow_bounds(node, bounds, grown);
+        }
+
+        static bool sweep(const box<TCoordinate, N>& bounds, const vector& velocity,
+            const box<TCoordinate, N>& target, double duration, double& time)
+        {
+            return sweep_bounds(bounds, velocity, target, duration, time);
+        }
+    };
+
+    /// <summary>
+    /// Tree where each internal node has exactly eight children, partitioning
+    /// the 3D space of its bounds into eight octants.
+    /// </summary>
+    template<typename TElement, typename TCoordinate, std::size_t Depth, typename TAggregate = void, bool Epochs = false>
+    using octree = ntree<TElement, box<TCoordinate, 3>, Depth, TAggregate, Epochs>;
+}
+
+#endif
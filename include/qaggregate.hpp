@@ -0,0 +1,220 @@
+#ifndef QTREE_QAGGREGATE_H_
+#define QTREE_QAGGREGATE_H_
+
+#include "qnode.hpp"
+
+#include <cstddef>
+#include <utility>
+
+namespace qtree
+{
+    /// <summary>
+    /// Aggregate counting the elements. An aggregate is a monoid over the elements,
+    /// that provides: the type of the summaries, value_type; the summary of no
+    /// elements, identity(); the summary of a single element, value(element, bounds);
+    /// and the associative combination of two summaries, combine(lhs, rhs).
+    /// </summary>
+    struct count_aggregate
+    {
+        using value_type = std::size_t;
+
+        static value_type identity()
+        {
+            return 0;
+        }
+
+        template<typename TElement, typename TBounds>
+        static value_type value(const TElement&, const TBounds&)
+        {
+            return 1;
+        }
+
+        static value_type combine(value_type lhs, value_type rhs)
+        {
+            return lhs + rhs;
+        }
+    };
+
+    /// <summary>
+    /// Summary of the elements of a tree node and of all its children,
+    /// according to the given aggregate. The summary of the elements of the node
+    /// alone is kept as well, so that a removal recomputes only the summary of
+    /// the node the element left.
+    /// </summary>
+    template<typename TAggregate>
+    class aggregate_node
+    {
+    public:
+
+        /// Summary of a group of elements.
+        using TSummary = typename TAggregate::value_type;
+
+        /// <summary>
+        /// Gets the summary of the elements of this node and of all its children.
+        /// </summary>
+        const TSummary& summary() const
+        {
+            return _summary;
+        }
+
+
+    protected:
+
+        aggregate_node()
+            : _own(TAggregate::identity())
+            , _summary(TAggregate::identity())
+        {
+        }
+
+        /// <summary>
+        /// Gets the summary of a single element.
+        /// </summary>
+        template<typename TElement, typename TBounds>
+        static TSummary aggregate_value(const TElement& element, const TBounds& bounds)
+        {
+            return TAggregate::value(element, bounds);
+        }
+
+        /// <summary>
+        /// Adds the summary of an element inserted into one of the children of this node.
+        /// </summary>
+        void aggregate_insert(const TSummary& value)
+        {
+            _summary = TAggregate::combine(_summary, value);
+        }
+
+        /// <summary>
+        /// Adds the summary of an element inserted into this node.
+        /// </summary>
+        void aggregate_insert_own(const TSummary& value)
+        {
+            _own = TAggregate::combine(_own, value);
+            _summary = TAggregate::combine(_summary, value);
+        }
+
+        /// <summary>
+        /// Computes again the summary from the elements of the given node (aggregates may
+        /// not be able to subtract a removed element).
+        /// </summary>
+        template<typename TElement, typename TCoordinate, typename TBounds>
+        void aggregate_update(const qnode<TElement, TCoordinate, TBounds>& node)
+        {
+            auto summary = TAggregate::identity();
+
+            node.for_each_element([&summary](const TElement& element, const TBounds& bounds)
+            {
+                summary = TAggregate::combine(summary, TAggregate::value(element, bounds));
+            });
+
+            _own = std::move(summary);
+            _summary = _own;
+        }
+
+        /// <summary>
+        /// Computes again the summary from the elements of the given node, that an element
+        /// has been removed from, and from the summaries of the given children.
+        /// </summary>
+        template<typename TElement, typename TCoordinate, typename TBounds, typename TChildren>
+        void aggregate_update(const qnode<TElement, TCoordinate, TBounds>& node, const TChildren& children)
+        {
+            aggregate_update(node);
+            aggregate_combine(children);
+        }
+
+        /// <summary>
+        /// Computes again the summary from the one of the elements of this node and from
+        /// the summaries of the given children, one of which changed.
+        /// </summary>
+        template<typename TChildren>
+        void aggregate_combine(const TChildren& children)
+        {
+            _summary = _own;
+
+            for (const auto& child : children)
+            {
+                _summary = TAggregate::combine(_summary, child->summary());
+            }
+        }
+
+        /// <summary>
+        /// Adds to the given summary the elements of the given node that intersect the given area.
+        /// </summary>
+        template<typename TElement, typename TCoordinate, typename TBounds>
+        static void aggregate_overlapping(const qnode<TElement, TCoordinate, TBounds>& node,
+            const TBounds& area, TSummary& summary)
+        {
+            node.for_each_element([&area, &summary](const TElement& element, const TBounds& bounds)
+            {
+                QTREE_STATS_ADD(elements_tested, 1);
+
+                if (area.overlaps(bounds))
+                {
+                    summary = TAggregate::combine(summary, TAggregate::value(element, bounds));
+                }
+            });
+        }
+
+        /// <summary>
+        /// Resets the summary to the one of no elements.
+        /// </summary>
+        void aggregate_clear()
+        {
+            _own = TAggregate::identity();
+            _summary = TAggregate::identity();
+        }
+
+
+    private:
+
+        /// Summary of the elements of this node only.
+        TSummary _own;
+        TSummary _summary;
+    };
+
+    /// <summary>
+    /// Nodes of the trees without aggregate hold no summary.
+    /// </summary>
+    template<>
+    class aggregate_node<void>
+    {
+    protected:
+
+        /// Placeholder for the summary of a single element.
+        struct TSummary {};
+
+        template<typename TElement, typename TBounds>
+        static TSummary aggregate_value(const TElement&, const TBounds&)
+        {
+            return TSummary();
+        }
+
+        void aggregate_insert(const TSummary&)
+        {
+        }
+
+        void aggregate_insert_own(const TSummary&)
+        {
+        }
+
+        template<typename TNode>
+        void aggregate_update(const TNode&)
+        {
+        }
+
+        template<typename TNode, typename TChildren>
+        void aggregate_update(const TNode&, const TChildren&)
+        {
+        }
+
+        template<typename TChildren>
+        void aggregate_combine(const TChildren&)
+        {
+        }
+
+        void aggregate_clear()
+        {
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,556 @@
+#ifndef QTREE_QBUILDER_H_
+#define QTREE_QBUILDER_H_
+
+#include "qformat.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace qtree
+{
+    /// <summary>
+    /// Builds a serialized quad tree (see serialize) from a stream of elements
+    /// that do not need to fit in memory.
+    /// </summary>
+    /// <remarks>The elements are buffered in chunks: each chunk is sorted by the pre-order
+    /// index of the nodes and appended to a temporary file as a run. When the building is
+    /// finished the runs are merged, reading a slice of each one at a time, so that the element
+    /// records and the node entries are written in order. The slices are never smaller than
+    /// min_slice(), therefore when the chunk cannot hold a slice of each run, the runs are first
+    /// merged in groups into longer ones (in more passes if needed). The memory used depends only
+    /// on the chunk size (or 16 slices, if larger) and on the number of runs (a few words each),
+    /// not on the depth.</remarks>
+    template<typename TElement, typename TCoordinate>
+    class qbuilder
+    {
+        using TRecord = qrecord<TElement, TCoordinate>;
+
+        /// Spilled element, with the pre-order index of the node it belongs to.
+        struct TSpilled
+        {
+            std::uint64_t node;
+            TRecord record;
+        };
+
+        /// Sorted run of spilled elements, with the slice of it being merged.
+        struct TRun
+        {
+            std::uint64_t offset;
+            std::uint64_t remaining;
+            std::vector<TSpilled> slice;
+            std::size_t position;
+        };
+
+    public:
+
+        /// <summary>
+        /// Initializes the instance with the given bounds and depth.
+        /// Throws std::invalid_argument if the depth is greater than 30
+        /// or the chunk size is zero.
+        /// </summary>
+        /// <param name="bounds">Quad tree bounds.</param>
+        /// <param name="depth">Quad tree depth.</param>
+        /// <param name="path">Path of the output file, also used as prefix of the
+        /// temporary file.</param>
+        /// <param name="chunk">Maximum number of elements held in memory.</param>
+        qbuilder(rect<TCoordinate> bounds, std::size_t depth, std::string path, std::size_t chunk = 1 << 16)
+            : _bounds(std::move(bounds))
+            , _depth(depth > 30 ? throw std::invalid_argument("Invalid depth.") : depth)
+            , _path(std::move(path))
+            , _chunk(chunk == 0 ? throw std::invalid_argument("Invalid chunk size.") : chunk)
+            , _size()
+            , _finished(false)
+        {
+            static_assert(std::is_trivially_copyable<TElement>::value, "The elements must be trivially copyable.");
+
+            for (std::size_t d = 0; d <= _depth; d++)
+            {
+                _subtrees.push_back(qformat_nodes(d));
+            }
+
+            _buffer.reserve(_chunk);
+        }
+
+        qbuilder(const qbuilder&) = delete;
+        qbuilder& operator=(const qbuilder&) = delete;
+
+        ~qbuilder() noexcept
+        {
+            if (_spill.is_open())
+            {
+                _spill.close();
+                std::remove(spill_path().c_str());
+            }
+        }
+
+        /// <summary>
+        /// Gets the minimum number of elements read at a time from each run while merging
+        /// (16 KiB of them), so that the temporary file is not read one element at a time.
+        /// </summary>
+        constexpr static std::size_t min_slice()
+        {
+            return (16 << 10) / sizeof(TSpilled) > 0 ? (16 << 10) / sizeof(TSpilled) : 1;
+        }
+
+        /// <summary>
+        /// Gets the bounds of the quad tree being built.
+        /// </summary>
+        rect<TCoordinate> get_bounds() const
+        {
+            return _bounds;
+        }
+
+        /// <summary>
+        /// Gets the depth of the quad tree being built.
+        /// </summary>
+        std::size_t depth() const
+        {
+            return _depth;
+        }
+
+        /// <summary>
+        /// Gets the number of elements inserted so far.
+        /// </summary>
+        std::size_t size() const
+        {
+            return static_cast<std::size_t>(_size);
+        }
+
+        /// <summary>
+        /// Insert the given element into the quad tree being built.
+        /// </summary>
+        /// <param name="element">Element to be inserted.</param>
+        /// <param name="bounds">Element bounds.</param>
+        /// <returns>Returns true only if the element has been inserted,
+        /// otherwise returns false.</returns>
+        bool insert(TElement element, rect<TCoordinate> bounds)
+        {
+            if (_finished || !_bounds.contains(bounds))
+            {
+                return false;
+            }
+
+            const auto node = locate(bounds);
+            _buffer.push_back(TSpilled{ node, TRecord{ std::move(element), std::move(bounds) } });
+            _size++;
+
+            if (_buffer.size() >= _chunk)
+            {
+                spill();
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Insert all the element records (see qrecord) read from the given binary stream.
+        /// </summary>
+        /// <param name="records">Binary input stream, read until its end.</param>
+        /// <returns>Returns true only if all the records have been inserted and the stream
+        /// does not end with a partial record, otherwise returns false.</returns>
+        bool insert(std::istream& records)
+        {
+            std::vector<TRecord> chunk(_chunk);
+            bool inserted = true;
+
+            while (records)
+            {
+                records.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(chunk.size() * sizeof(TRecord)));
+                const auto bytes = static_cast<std::size_t>(records.gcount());
+
+                for (std::size_t i = 0; i < bytes / sizeof(TRecord); i++)
+                {
+                    inserted = insert(chunk[i].element, chunk[i].bounds) && inserted;
+                }
+
+                // only the last read can stop in the middle of a record
+                inserted = inserted && bytes % sizeof(TRecord) == 0;
+            }
+
+            return inserted && !records.bad();
+        }
+
+        /// <summary>
+        /// Writes the output file and removes the temporary one.
+        /// No other element can be inserted afterwards.
+        /// </summary>
+        /// <returns>Returns true only if the output file has been written,
+        /// otherwise returns false.</returns>
+        bool finish()
+        {
+            if (_finished)
+            {
+                return false;
+            }
+
+            _finished = true;
+            spill();
+
+            bool good = true;
+            const bool spilled = _spill.is_open();
+            std::ifstream in;
+
+            if (spilled)
+            {
+                _spill.close();
+                good = !_spill.fail();
+                in.open(spill_path(), std::ios::binary);
+            }
+
+            // the entries are written after the records, whose number is already known,
+            // and the header is written again at the end with the number of entries
+            std::ofstream out(_path, std::ios::binary | std::ios::trunc);
+            serialize_head<TElement, TCoordinate>(out, _bounds, _depth, 0, _size);
+
+            const qlayout<TElement, TCoordinate> layout(0, _size);
+            std::vector<qentry> entries;
+            std::uint64_t nodes = 0;
+            std::uint64_t records = 0;
+
+            auto flush = [&]()
+            {
+                out.seekp(static_cast<std::streamoff>(layout.entries + nodes * sizeof(qentry)));
+                out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(qentry)));
+                out.seekp(static_cast<std::streamoff>(layout.records + records * sizeof(TRecord)));
+                nodes += entries.size();
+                entries.clear();
+            };
+
+            qindex index([&](const qentry& entry)
+            {
+                entries.push_back(entry);
+
+                if (entries.size() >= _chunk)
+                {
+                    flush();
+                }
+            });
+
+            // the root always has an entry
+            std::vector<std::uint64_t> path{ 0 };
+            index.add(0, 0, 0);
+
+            // the chunk holds a slice of each of the runs merged at once (merging at least
+            // 16 of them, so that the small chunks do not need too many passes)
+            const auto fanin = std::max<std::size_t>(16, _chunk / min_slice());
+            const auto slice = std::max(min_slice(), _chunk / fanin);
+
+            while (good && _runs.size() > fanin)
+            {
+                good = merge_runs(in, fanin, slice);
+            }
+
+            good = good && merge(in, 0, _runs.size(), slice, [&](const TSpilled& spilled)
+            {
+                if (spilled.node != path.back())
+                {
+                    open(index, path, spilled.node);
+                }
+
+                index.append(1);
+                serialize_record(out, spilled.record.element, spilled.record.bounds);
+                records++;
+
+                return out.good();
+            });
+
+            index.finish();
+            flush();
+
+            out.seekp(static_cast<std::streamoff>(layout.records + _size * sizeof(TRecord)));
+            serialize_padding(out, layout.records + _size * sizeof(TRecord), layout.entries);
+            out.seekp(0);
+            serialize_head<TElement, TCoordinate>(out, _bounds, _depth, nodes, _size);
+            out.close();
+
+            if (spilled)
+            {
+                in.close();
+                std::remove(spill_path().c_str());
+            }
+
+            _runs.clear();
+            _buffer.clear();
+            _buffer.shrink_to_fit();
+
+            return good && !out.fail();
+        }
+
+
+    private:
+
+        /// <summary>
+        /// Gets the path of the temporary file of the runs.
+        /// </summary>
+        std::string spill_path() const
+        {
+            return _path + ".tmp";
+        }
+
+        /// <summary>
+        /// Gets the path of the temporary file of the runs being merged in groups.
+        /// </summary>
+        std::string merge_path() const
+        {
+            return _path + ".tmp.merge";
+        }
+
+        /// <summary>
+        /// Merges the given range of runs, reading a slice of each one at a time.
+        /// </summary>
+        /// <param name="in">Temporary file of the runs.</param>
+        /// <param name="first">Index of the first run.</param>
+        /// <param name="last">Index of the run after the last one.</param>
+        /// <param name="slice">Number of elements read at a time from each run.</param>
+        /// <param name="consume">Function invoked as consume(spilled) with the elements in
+        /// order, that returns false to stop the merge.</param>
+        /// <returns>Returns true only if all the elements have been consumed,
+        /// otherwise returns false.</returns>
+        template<typename TConsume>
+        bool merge(std::ifstream& in, std::size_t first, std::size_t last, std::size_t slice, TConsume&& consume)
+        {
+            // the next element is the one of the node with the lowest pre-order index
+            // (from the earliest run, on ties, to keep the insertion order)
+            std::priority_queue<std::pair<std::uint64_t, std::size_t>, std::vector<std::pair<std::uint64_t, std::size_t>>,
+                std::greater<std::pair<std::uint64_t, std::size_t>>> next;
+
+            bool good = true;
+
+            for (auto i = first; good && i < last; i++)
+            {
+                good = read(in, _runs[i], slice);
+                next.emplace(_runs[i].slice.front().node, i);
+            }
+
+            while (good && !next.empty())
+            {
+                const auto i = next.top().second;
+                auto& run = _runs[i];
+                next.pop();
+
+                good = consume(run.slice[run.position]);
+
+                if (++run.position == run.slice.size() && run.remaining > 0)
+                {
+                    good = good && read(in, run, slice);
+                }
+
+                if (run.position < run.slice.size())
+                {
+                    next.emplace(run.slice[run.position].node, i);
+                }
+            }
+
+            // the slices are not needed anymore
+            for (auto i = first; i < last; i++)
+            {
+                std::vector<TSpilled>().swap(_runs[i].slice);
+            }
+
+            return good;
+        }
+
+        /// <summary>
+        /// Merges each group of the given number of consecutive runs into a single run,
+        /// replacing the temporary file, that is opened again by the given stream.
+        /// </summary>
+        bool merge_runs(std::ifstream& in, std::size_t fanin, std::size_t slice)
+        {
+            std::ofstream out(merge_path(), std::ios::binary | std::ios::trunc);
+            std::vector<TRun> runs;
+            std::vector<TSpilled> buffer;
+            bool good = true;
+
+            auto flush = [&]()
+            {
+                out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(TSpilled)));
+                buffer.clear();
+                return out.good();
+            };
+
+            for (std::size_t first = 0; good && first < _runs.size(); first += fanin)
+            {
+                const auto offset = runs.empty() ? 0 : runs.back().offset + runs.back().remaining;
+                runs.push_back(TRun{ offset, 0, {}, 0 });
+
+                auto& run = runs.back();
+                good = merge(in, first, std::min(first + fanin, _runs.size()), slice, [&](const TSpilled& spilled)
+                {
+                    buffer.push_back(spilled);
+                    run.remaining++;
+                    return buffer.size() < slice || flush();
+                });
+
+                good = good && flush();
+            }
+
+            out.close();
+            in.close();
+            good = good && !out.fail();
+
+            // the merged runs replace the previous ones
+            if (good && std::remove(spill_path().c_str()) == 0 && std::rename(merge_path().c_str(), spill_path().c_str()) == 0)
+            {
+                _runs = std::move(runs);
+                in.open(spill_path(), std::ios::binary);
+                return in.good();
+            }
+
+            std::remove(merge_path().c_str());
+            return false;
+        }
+
+        /// <summary>
+        /// Gets the pre-order index of the deepest node that completely contains the given bounds,
+        /// reached through Morton codes as in quadtree::insert.
+        /// </summary>
+        std::uint64_t locate(const rect<TCoordinate>& bounds) const
+        {
+            const auto location = morton_locate(_bounds, bounds, _depth);
+
+            std::uint64_t index = 0;
+            auto node = _bounds;
+            auto depth = _depth;
+
+            for (auto levels = location.second; levels > 0; levels--, depth--)
+            {
+                const auto child = morton_child((location.first >> (2 * (depth - 1))) & 3);
+                index += 1 + child * _subtrees[depth - 1];
+                node = child_bounds(node, child);
+            }
+
+            if (!node.contains(bounds))
+            {
+                // rounding errors may cause the addressed node to not contain the item:
+                // fall back to testing the children bounds level by level from the root.
+                index = 0;
+                node = _bounds;
+                depth = _depth;
+            }
+
+            // the Morton cells may not match the children borders (such as the rounded ones
+            // of integer coordinates): keep going down while a child contains the item
+            for (; depth > 0; depth--)
+            {
+                std::size_t child = 0;
+
+                while (child < 4 && !child_bounds(node, child).contains(bounds))
+                {
+                    child++;
+                }
+
+                if (child == 4)
+                {
+                    break;
+                }
+
+                index += 1 + child * _subtrees[depth - 1];
+                node = child_bounds(node, child);
+            }
+
+            return index;
+        }
+
+        /// <summary>
+        /// Adds to the given index the nodes from the deepest ancestor of the given node
+        /// that is still open down to the node itself, updating the path of the open nodes.
+        /// </summary>
+        void open(qindex& index, std::vector<std::uint64_t>& path, std::uint64_t node) const
+        {
+            std::uint64_t current = 0;
+            std::size_t location = 0;
+
+            for (std::size_t level = 0;; level++)
+            {
+                if (level >= path.size() || path[level] != current)
+                {
+                    path.resize(level);
+                    path.push_back(current);
+                    index.add(level, location, 0);
+                }
+
+                if (current == node)
+                {
+                    break;
+                }
+
+                // the children subtrees follow their parent node one after the other
+                const auto subtree = _subtrees[_depth - level - 1];
+                location = static_cast<std::size_t>((node - current - 1) / subtree);
+                current += 1 + location * subtree;
+            }
+        }
+
+        /// <summary>
+        /// Reads the next slice of the given run from the temporary file.
+        /// </summary>
+        bool read(std::ifstream& in, TRun& run, std::size_t slice) const
+        {
+            const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(run.remaining, slice));
+
+            run.slice.resize(count);
+            run.position = 0;
+
+            in.seekg(static_cast<std::streamoff>(run.offset * sizeof(TSpilled)));
+            in.read(reinterpret_cast<char*>(run.slice.data()), static_cast<std::streamsize>(count * sizeof(TSpilled)));
+
+            run.offset += count;
+            run.remaining -= count;
+            return in.good();
+        }
+
+        /// <summary>
+        /// Sorts the buffered elements by node, keeping their order within each node,
+        /// and appends them to the temporary file as a new run.
+        /// </summary>
+        void spill()
+        {
+            if (_buffer.empty())
+            {
+                return;
+            }
+
+            if (!_spill.is_open())
+            {
+                _spill.open(spill_path(), std::ios::binary | std::ios::trunc);
+            }
+
+            std::stable_sort(_buffer.begin(), _buffer.end(),
+                [](const TSpilled& a, const TSpilled& b) { return a.node < b.node; });
+
+            const auto offset = _runs.empty() ? 0 : _runs.back().offset + _runs.back().remaining;
+            _runs.push_back(TRun{ offset, _buffer.size(), {}, 0 });
+
+            _spill.write(reinterpret_cast<const char*>(_buffer.data()), static_cast<std::streamsize>(_buffer.size() * sizeof(TSpilled)));
+            _buffer.clear();
+        }
+
+        const rect<TCoordinate> _bounds;
+        const std::size_t _depth;
+        const std::string _path;
+        const std::size_t _chunk;
+
+        std::uint64_t _size;
+        bool _finished;
+
+        /// Number of nodes of a subtree of each depth.
+        std::vector<std::uint64_t> _subtrees;
+        std::vector<TSpilled> _buffer;
+
+        std::ofstream _spill;
+        std::vector<TRun> _runs;
+    };
+}
+
+#endif
@@ -0,0 +1,257 @@
+#ifndef QTREE_QCONTEXT_H_
+#define QTREE_QCONTEXT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace qtree
+{
+    template<typename TElement, typename TBounds, std::size_t Depth, typename TAggregate, bool Epochs>
+    class ntree;
+
+    /// <summary>
+    /// Identity and number of modifications of a tree node, used by qcontext to know
+    /// whether the cached results of the node are still valid.
+    /// </summary>
+    template<bool Epochs>
+    class epoch_node
+    {
+    public:
+
+        /// <summary>
+        /// Gets the identifier of this node, unique among all the nodes created by the
+        /// program (unlike its address, that can be reused after the node is destroyed).
+        /// </summary>
+        std::uint64_t id() const
+        {
+            return _id;
+        }
+
+        /// <summary>
+        /// Gets the number of modifications of the elements of this node and
+        /// of its children, that changes whenever any of them changes.
+        /// </summary>
+        std::uint64_t epoch() const
+        {
+            return _epoch;
+        }
+
+
+    protected:
+
+        epoch_node()
+            : _id(next_id())
+            , _epoch()
+        {
+        }
+
+        /// <summary>
+        /// Records a modification of the elements of this node or of its children.
+        /// </summary>
+        void touch()
+        {
+            ++_epoch;
+        }
+
+
+    private:
+
+        static std::uint64_t next_id()
+        {
+            static std::atomic<std::uint64_t> id(1);
+            return id.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::uint64_t _id;
+        std::uint64_t _epoch;
+    };
+
+    /// <summary>
+    /// Nodes of the trees not queried through a qcontext hold no epoch.
+    /// </summary>
+    template<>
+    class epoch_node<false>
+    {
+    protected:
+
+        void touch()
+        {
+        }
+    };
+
+    /// <summary>
+    /// Context of the area queries repeated over time on the same tree, such as the ones made
+    /// every frame by a slowly moving viewer. It remembers the deepest node that completely
+    /// contains the last area and the results of the subtrees completely contained by it, so
+    /// that the next query can reuse the results of the nodes whose epoch did not change.
+    /// </summary>
+    /// <remarks>Only the trees with epochs (the Epochs template argument of ntree) can be
+    /// queried through a context. The context keeps references to the elements of the tree:
+    /// they are never used once the tree is destroyed, because the nodes are identified
+    /// by their unique ids, but the memory is released only by reset.</remarks>
+    template<typename TElement, typename TBounds>
+    class qcontext
+    {
+        template<typename, typename, std::size_t, typename, bool>
+        friend class ntree;
+
+        /// Vector of references to the tree items.
+        using TElementRefContainer = std::vector<std::reference_wrapper<TElement>>;
+
+
+    public:
+
+        /// <summary>
+        /// Gets the number of cached results reused by the last query.
+        /// </summary>
+        std::size_t reused() const
+        {
+            return _reused;
+        }
+
+        /// <summary>
+        /// Gets the number of subtrees whose results are cached.
+        /// </summary>
+        std::size_t cached() const
+        {
+            return _subtrees.size();
+        }
+
+        /// <summary>
+        /// Forgets the previous queries.
+        /// </summary>
+        void reset()
+        {
+            *this = qcontext();
+        }
+
+
+    private:
+
+        /// Results of a node, valid as long as its epoch does not change.
+        struct TEntry
+        {
+            std::uint64_t node = 0;
+            std::uint64_t epoch = 0;
+            std::size_t generation = 0;
+            TElementRefContainer elements;
+        };
+
+        /// <summary>
+        /// Starts a query of the given area on the tree with the given id.
+        /// </summary>
+        void begin(std::uint64_t tree, const TBounds& area)
+        {
+            if (tree != _tree)
+            {
+                reset();
+                _tree = tree;
+            }
+
+            _same = _valid && _area == area;
+            _traversed = false;
+            _generation++;
+            _reused = 0;
+        }
+
+        /// <summary>
+        /// Adds the results of the last query only if it had the same area and
+        /// the tree did not change since.
+        /// </summary>
+        bool reuse_all(std::uint64_t epoch, TElementRefContainer& elements)
+        {
+            return _same && reuse(_all, _all.node, epoch, elements);
+        }
+
+        /// <summary>
+        /// Adds the results of the start node of the last query only if it had
+        /// the same area and the node did not change since.
+        /// </summary>
+        bool reuse_start(std::uint64_t node, std::uint64_t epoch, TElementRefContainer& elements)
+        {
+            return _same && reuse(_start, node, epoch, elements);
+        }
+
+        /// <summary>
+        /// Adds all the elements of the given subtree if they are cached
+        /// and the subtree did not change since.
+        /// </summary>
+        bool reuse_subtree(std::uint64_t node, std::uint64_t epoch, TElementRefContainer& elements)
+        {
+            const auto it = _subtrees.find(node);
+            return it != _subtrees.end() && reuse(it->second, node, epoch, elements);
+        }
+
+        void store_start(std::uint64_t node, std::uint64_t epoch, const TElementRefContainer& elements, std::size_t first)
+        {
+            store(_start, node, epoch, elements, first);
+            _traversed = true;
+        }
+
+        void store_subtree(std::uint64_t node, std::uint64_t epoch, const TElementRefContainer& elements, std::size_t first)
+        {
+            store(_subtrees[node], node, epoch, elements, first);
+        }
+
+        /// <summary>
+        /// Ends a query, keeping its results and forgetting the subtrees it did not use
+        /// (unless the results of its start node were reused as a whole).
+        /// </summary>
+        void end(const TBounds& area, const std::pair<std::uint64_t, std::size_t>& location,
+            std::uint64_t epoch, const TElementRefContainer& elements, std::size_t first)
+        {
+            _valid = true;
+            _area = area;
+            _location = location;
+            store(_all, _tree, epoch, elements, first);
+
+            for (auto it = _subtrees.begin(); _traversed && it != _subtrees.end();)
+            {
+                it = it->second.generation == _generation ? std::next(it) : _subtrees.erase(it);
+            }
+        }
+
+        bool reuse(TEntry& entry, std::uint64_t node, std::uint64_t epoch, TElementRefContainer& elements)
+        {
+            if (entry.node != node || entry.epoch != epoch)
+            {
+                return false;
+            }
+
+            elements.insert(elements.end(), entry.elements.begin(), entry.elements.end());
+            entry.generation = _generation;
+            _reused++;
+            return true;
+        }
+
+        void store(TEntry& entry, std::uint64_t node, std::uint64_t epoch, const TElementRefContainer& elements, std::size_t first)
+        {
+            entry.node = node;
+            entry.epoch = epoch;
+            entry.generation = _generation;
+            entry.elements.assign(elements.begin() + first, elements.end());
+        }
+
+        std::uint64_t _tree = 0;
+        bool _valid = false;
+        bool _same = false;
+        bool _traversed = false;
+        TBounds _area;
+        /// Morton code and levels of the deepest node containing the last area.
+        std::pair<std::uint64_t, std::size_t> _location;
+        std::size_t _generation = 0;
+        std::size_t _reused = 0;
+
+        TEntry _all;
+        TEntry _start;
+        std::unordered_map<std::uint64_t, TEntry> _subtrees;
+    };
+}
+
+#endif
@@ -0,0 +1,333 @@
+#ifndef QTREE_QFORMAT_H_
+#define QTREE_QFORMAT_H_
+
+#include "quadtree.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace qtree
+{
+    /// <summary>
+    /// Current version of the quad tree binary format.
+    /// </summary>
+    constexpr std::uint32_t qformat_version() { return 2; }
+
+    /// <summary>
+    /// Value written in the header to detect a byte order mismatch.
+    /// </summary>
+    constexpr std::uint32_t qformat_byte_order() { return 0x01020304; }
+
+    /// <summary>
+    /// Gets the number of nodes of a complete quad tree of the given depth.
+    /// </summary>
+    constexpr std::uint64_t qformat_nodes(std::size_t depth)
+    {
+        return depth == 0 ? 1 : 1 + 4 * qformat_nodes(depth - 1);
+    }
+
+    /// <summary>
+    /// Rounds up the given offset to a multiple of the given alignment.
+    /// </summary>
+    constexpr std::uint64_t qformat_align(std::uint64_t offset, std::uint64_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    /// <summary>
+    /// Fixed size header at the beginning of a serialized quad tree.
+    /// </summary>
+    /// <remarks>A serialized quad tree is made of (in this order, each section aligned
+    /// to its own type): the header, the root bounds, the element records of the nodes in
+    /// depth-first pre-order and the entries of the nodes in depth-first post-order.
+    /// Since the nodes are in pre-order, the elements of a whole subtree are contiguous.
+    /// Only the root and the nodes whose subtree has elements have an entry, so the size
+    /// does not depend on the depth. All the values are stored with the byte order of the
+    /// machine that wrote them.</remarks>
+    struct qheader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t byte_order;
+        std::uint32_t depth;
+        std::uint32_t coordinate_size;
+        std::uint32_t record_size;
+        std::uint64_t nodes;
+        std::uint64_t elements;
+    };
+
+    /// <summary>
+    /// Serialized quad tree node.
+    /// </summary>
+    /// <remarks>The entries of the children of a node precede it, and the entries of the
+    /// whole subtree of a node are the ones preceding it: the root entry is the last one.</remarks>
+    struct qentry
+    {
+        /// Index of the first element record of the subtree (the ones of the node come first).
+        std::uint64_t first;
+        /// Number of element records of the node.
+        std::uint64_t own;
+        /// Number of element records of the subtree.
+        std::uint64_t elements;
+        /// Number of entries of the subtree, including this one.
+        std::uint64_t nodes;
+        /// Bit mask of the locations of the children that have an entry.
+        std::uint32_t children;
+        std::uint32_t reserved;
+    };
+
+    /// <summary>
+    /// Serialized quad tree element.
+    /// </summary>
+    template<typename TElement, typename TCoordinate>
+    struct qrecord
+    {
+        TElement element;
+        rect<TCoordinate> bounds;
+    };
+
+    /// <summary>
+    /// Offsets, in bytes, of the sections of a serialized quad tree.
+    /// </summary>
+    template<typename TElement, typename TCoordinate>
+    struct qlayout
+    {
+        using TRecord = qrecord<TElement, TCoordinate>;
+
+        /// <summary>
+        /// Computes the layout of a quad tree with the given number of entries and elements.
+        /// </summary>
+        constexpr qlayout(std::uint64_t nodes, std::uint64_t elements)
+            : bounds{qformat_align(sizeof(qheader), alignof(rect<TCoordinate>))}
+            , records{qformat_align(bounds + sizeof(rect<TCoordinate>), alignof(TRecord))}
+            , entries{qformat_align(records + elements * sizeof(TRecord), alignof(qentry))}
+            , size{entries + nodes * sizeof(qentry)}
+        {
+        }
+
+        const std::uint64_t bounds;
+        const std::uint64_t records;
+        const std::uint64_t entries;
+        const std::uint64_t size;
+    };
+
+    /// <summary>
+    /// Computes the entries of a serialized quad tree from its nodes, given in depth-first
+    /// pre-order, and passes them to the given output in depth-first post-order.
+    /// </summary>
+    class qindex
+    {
+    public:
+
+        /// <summary>
+        /// Initializes the instance with the given output.
+        /// </summary>
+        /// <param name="output">Function invoked as output(entry) for each entry.</param>
+        explicit qindex(std::function<void(const qentry&)> output)
+            : _output(std::move(output))
+            , _elements()
+            , _nodes()
+        {
+        }
+
+        /// <summary>
+        /// Adds the next node in depth-first pre-order. The nodes without elements can be
+        /// skipped, unless one of their descendants is added.
+        /// </summary>
+        /// <param name="level">Number of levels between the root and the node.</param>
+        /// <param name="location">Location of the node among its siblings.</param>
+        /// <param name="elements">Number of elements of the node.</param>
+        void add(std::size_t level, std::size_t location, std::uint64_t elements)
+        {
+            while (_path.size() > level)
+            {
+                close();
+            }
+
+            _path.push_back({ { _elements, elements, elements, 1, 0, 0 }, location });
+            _elements += elements;
+        }
+
+        /// <summary>
+        /// Adds the given number of elements to the last node added.
+        /// </summary>
+        void append(std::uint64_t elements)
+        {
+            auto& node = _path.back().first;
+            node.own += elements;
+            node.elements += elements;
+            _elements += elements;
+        }
+
+        /// <summary>
+        /// Passes the entries of the nodes still open to the output.
+        /// </summary>
+        /// <returns>Returns the number of entries passed to the output.</returns>
+        std::uint64_t finish()
+        {
+            while (!_path.empty())
+            {
+                close();
+            }
+
+            return _nodes;
+        }
+
+
+    private:
+
+        /// <summary>
+        /// Passes the entry of the last node of the path to the output, unless its subtree
+        /// is empty and it is not the root, and adds its subtree to its parent.
+        /// </summary>
+        void close()
+        {
+            const auto node = _path.back();
+            _path.pop_back();
+
+            if (!_path.empty() && node.first.elements == 0)
+            {
+                return;
+            }
+
+            _output(node.first);
+            _nodes++;
+
+            if (!_path.empty())
+            {
+                auto& parent = _path.back().first;
+                parent.elements += node.first.elements;
+                parent.nodes += node.first.nodes;
+                parent.children |= 1u << node.second;
+            }
+        }
+
+        const std::function<void(const qentry&)> _output;
+
+        /// Entries of the nodes from the root to the last one added, with their locations.
+        std::vector<std::pair<qentry, std::size_t>> _path;
+        std::uint64_t _elements;
+        std::uint64_t _nodes;
+    };
+
+    /// <summary>
+    /// Writes to the given stream the zeros padding the given offset to the next section.
+    /// </summary>
+    inline void serialize_padding(std::ostream& out, std::uint64_t offset, std::uint64_t next)
+    {
+        for (; offset < next; offset++)
+        {
+            out.put('\0');
+        }
+    }
+
+    /// <summary>
+    /// Writes to the given stream the header and the bounds of a serialized quad tree,
+    /// padded up to its element records (see serialize).
+    /// </summary>
+    /// <param name="out">Binary output stream.</param>
+    /// <param name="bounds">Quad tree bounds.</param>
+    /// <param name="depth">Quad tree depth.</param>
+    /// <param name="nodes">Number of entries.</param>
+    /// <param name="elements">Number of element records.</param>
+    template<typename TElement, typename TCoordinate>
+    void serialize_head(std::ostream& out, const rect<TCoordinate>& bounds, std::size_t depth,
+        std::uint64_t nodes, std::uint64_t elements)
+    {
+        const qheader header = {
+            { 'Q', 'T', 'R', 'E' },
+            qformat_version(),
+            qformat_byte_order(),
+            static_cast<std::uint32_t>(depth),
+            static_cast<std::uint32_t>(sizeof(TCoordinate)),
+            static_cast<std::uint32_t>(sizeof(qrecord<TElement, TCoordinate>)),
+            nodes,
+            elements
+        };
+
+        const qlayout<TElement, TCoordinate> layout(nodes, elements);
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        serialize_padding(out, sizeof(header), layout.bounds);
+        out.write(reinterpret_cast<const char*>(&bounds), sizeof(bounds));
+        serialize_padding(out, layout.bounds + sizeof(bounds), layout.records);
+    }
+
+    /// <summary>
+    /// Writes to the given stream the record of the given element, with zeroed padding
+    /// so that the same tree is always written with the same bytes.
+    /// </summary>
+    template<typename TElement, typename TCoordinate>
+    void serialize_record(std::ostream& out, const TElement& element, const rect<TCoordinate>& bounds)
+    {
+        using TRecord = qrecord<TElement, TCoordinate>;
+        static_assert(std::is_standard_layout<TRecord>::value, "The records must have a standard layout.");
+
+        char record[sizeof(TRecord)] = {};
+        std::memcpy(record + offsetof(TRecord, element), &element, sizeof(element));
+        std::memcpy(record + offsetof(TRecord, bounds), &bounds, sizeof(bounds));
+        out.write(record, sizeof(record));
+    }
+
+    /// <summary>
+    /// Writes the given quad tree to the given stream using the binary format
+    /// that can be queried through a qview.
+    /// </summary>
+    /// <param name="tree">Quad tree to serialize.</param>
+    /// <param name="out">Binary output stream.</param>
+    /// <returns>Returns true only if the quad tree has been written,
+    /// otherwise returns false.</returns>
+    template<typename TElement, typename TCoordinate, std::size_t Depth, typename TAggregate, bool Epochs>
+    bool serialize(const quadtree<TElement, TCoordinate, Depth, TAggregate, Epochs>& tree, std::ostream& out)
+    {
+        static_assert(std::is_trivially_copyable<TElement>::value, "The elements must be trivially copyable.");
+        static_assert(std::is_trivially_copyable<TCoordinate>::value, "The coordinates must be trivially copyable.");
+
+        // the nodes are visited in the same order their records are written
+        std::vector<qentry> entries;
+        qindex index([&entries](const qentry& entry) { entries.push_back(entry); });
+        std::size_t locations[Depth + 1] = {};
+
+        tree.visit([&index, &locations](const qnode<TElement, TCoordinate>& node, std::size_t depth)
+        {
+            const auto level = Depth - depth;
+            const auto location = level == 0 ? 0 : locations[level]++;
+            std::uint64_t count = 0;
+
+            node.for_each_element([&count](const TElement&, const rect<TCoordinate>&) { ++count; });
+            index.add(level, location, count);
+
+            if (level < Depth)
+            {
+                locations[level + 1] = 0;
+            }
+        });
+
+        index.finish();
+
+        const auto elements = entries.back().elements;
+        const qlayout<TElement, TCoordinate> layout(entries.size(), elements);
+        serialize_head<TElement, TCoordinate>(out, tree.get_bounds(), Depth, entries.size(), elements);
+
+        tree.visit([&out](const qnode<TElement, TCoordinate>& node, std::size_t)
+        {
+            node.for_each_element([&out](const TElement& element, const rect<TCoordinate>& bounds)
+            {
+                serialize_record(out, element, bounds);
+            });
+        });
+
+        serialize_padding(out, layout.records + elements * sizeof(qrecord<TElement, TCoordinate>), layout.entries);
+        out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(qentry)));
+
+        return out.good();
+    }
+}
+
+#endif
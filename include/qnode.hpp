@@ -1,6 +1,7 @@
 #ifndef QTREE_QNODE_H_
 #define QTREE_QNODE_H_
 
+#include "qstats.hpp"
 #include "rect.hpp"
 
 #include <functional>
@@ -9,7 +10,13 @@
 
 namespace qtree
 {
-    template<typename TElement, typename TCoordinate>
+    /// <summary>
+    /// Node of a tree partitioning the space, holding the elements whose bounds are
+    /// completely contained by the node bounds (but not by one of its children).
+    /// </summary>
+    /// <remarks>The bounds are 2D rects unless a different bounds type (such as box)
+    /// is given.</remarks>
+    template<typename TElement, typename TCoordinate, typename TBounds = rect<TCoordinate>>
     class qnode
     {
     public:
@@ -17,36 +24,53 @@ namespace qtree
         /// Vector of references to the node items.
         using TElementRefContainer = std::vector<std::reference_wrapper<TElement>>;
 
+        /// Vector of references to the node items, each one with its time of impact.
+        using TElementHitContainer = std::vector<std::pair<std::reference_wrapper<TElement>, double>>;
+
         /// <summary>
         /// Gets the node bounds.
         /// </summary>
-        constexpr rect<TCoordinate> get_bounds() const
+        constexpr TBounds get_bounds() const
         {
             return _bounds;
         }
 
         /// <summary>
-        /// Returns true only if the given rect can fit inside this node, otherwise returns false.
+        /// Returns true only if the given bounds can fit inside this node, otherwise returns false.
         /// </summary>
-        constexpr bool contains(const rect<TCoordinate>& rect) const
+        constexpr bool contains(const TBounds& bounds) const
         {
-            return _bounds.contains(rect);
+            return _bounds.contains(bounds);
         }
 
         /// <summary>
-        /// Returns true only if the given rect can fit inside this node, otherwise returns false.
+        /// Returns true only if the given bounds can fit inside this node, otherwise returns false.
         /// </summary>
-        constexpr bool inside(const rect<TCoordinate>& rect) const
+        constexpr bool inside(const TBounds& bounds) const
         {
-            return rect.contains(_bounds);
+            return bounds.contains(_bounds);
         }
 
         /// <summary>
-        /// Returns true only if this node overlaps the given rect, otherwise returns false.
+        /// Returns true only if this node overlaps the given bounds, otherwise returns false.
         /// </summary>
-        constexpr bool overlaps(const rect<TCoordinate>& rect) const
+        constexpr bool overlaps(const TBounds& bounds) const
         {
-            return _bounds.overlaps(rect);
+            return _bounds.overlaps(bounds);
+        }
+
+        /// <summary>
+        /// Invokes the given function for each element belonging to this node
+        /// (excluding the elements of its children), with the element bounds.
+        /// </summary>
+        /// <param name="function">Function invoked as function(element, bounds).</param>
+        template<typename TFunction>
+        void for_each_element(TFunction&& function) const
+        {
+            for (const auto& e : _elements)
+            {
+                function(e.first, e.second);
+            }
         }
 
 
@@ -56,7 +80,7 @@ namespace qtree
         /// Initializes the instance with the given bounds.
         /// </summary>
         /// <param name="bounds">Node bounds.</param>
-        constexpr explicit qnode(rect<TCoordinate> bounds)
+        constexpr explicit qnode(TBounds bounds)
             : _bounds(std::move(bounds))
         {
         }
@@ -94,7 +118,7 @@ namespace qtree
         /// <param name="bounds">Element bounds.</param>
         /// <returns>Returns true only if the element has been inserted,
         /// otherwise returns false.</returns>
-        virtual bool insert(TElement element, rect<TCoordinate> bounds)
+        virtual bool insert(TElement element, TBounds bounds)
         {
             if (!contains(bounds))
             {
@@ -105,12 +129,44 @@ namespace qtree
             return true;
         }
 
+        /// <summary>
+        /// Removes the given element from the node.
+        /// </summary>
+        /// <param name="element">Element to be removed.</param>
+        /// <param name="bounds">Bounds the element was inserted with.</param>
+        /// <returns>Returns true only if the element has been removed,
+        /// otherwise returns false.</returns>
+        /// <remarks>Not virtual, so that only the trees whose elements are removed require
+        /// them to be equality comparable.</remarks>
+        bool remove(const TElement& element, const TBounds& bounds)
+        {
+            for (auto it = _elements.begin(); it != _elements.end(); ++it)
+            {
+                if (it->second == bounds && it->first == element)
+                {
+                    // the elements order is not relevant: fill the gap with the last one
+                    if (it != _elements.end() - 1)
+                    {
+                        *it = std::move(_elements.back());
+                    }
+
+                    _elements.pop_back();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
         /// <summary>
         /// Gets all the elements of the node.
         /// </summary>
         /// <param name="elements">References to the elements of this node.</param>
         virtual void query(TElementRefContainer& elements) const
         {
+            QTREE_STATS_ADD(query_nodes, 1);
+            QTREE_STATS_ADD(elements_returned, _elements.size());
+
             for (const auto& e : _elements)
             {
                 elements.emplace_back(const_cast<TElement&>(e.first));
@@ -123,13 +179,17 @@ namespace qtree
         /// <param name="area">Area to overlaps.</param>
         /// <param name="elements">References to the elements of this node that intersect
         /// the given area.</param>
-        virtual void query(const rect<TCoordinate>& area, TElementRefContainer& elements) const
+        virtual void query(const TBounds& area, TElementRefContainer& elements) const
         {
+            QTREE_STATS_ADD(query_nodes, 1);
+            QTREE_STATS_ADD(elements_tested, _elements.size());
+
             for (const auto& e : _elements)
             {
                 if (area.overlaps(e.second))
                 {
                     elements.emplace_back(const_cast<TElement&>(e.first));
+                    QTREE_STATS_ADD(elements_returned, 1);
                 }
             }
         }
@@ -138,11 +198,11 @@ namespace qtree
     private:
 
         //// Each node is a pair where the first element is
-        /// the node item and the second element is the rect
-        /// the represents the bounds of the item.
-        using TElementWrapper = std::pair<TElement, rect<TCoordinate>>;
+        /// the node item and the second element is the bounds
+        /// of the item.
+        using TElementWrapper = std::pair<TElement, TBounds>;
 
-        const rect<TCoordinate> _bounds;
+        const TBounds _bounds;
         std::vector<TElementWrapper> _elements;
     };
 }
@@ -0,0 +1,85 @@
+#ifndef QTREE_QSTATS_H_
+#define QTREE_QSTATS_H_
+
+#include <cstddef>
+#include <vector>
+
+/// Define QTREE_ENABLE_STATS (before including any qtree header, and consistently
+/// across the program) to collect the traversal counters. When it is not defined
+/// the counters are never updated and add no overhead.
+#ifdef QTREE_ENABLE_STATS
+#define QTREE_STATS_ADD(counter, value) (::qtree::traversal_counters().counter += (value))
+#else
+#define QTREE_STATS_ADD(counter, value) ((void)0)
+#endif
+
+namespace qtree
+{
+    /// <summary>
+    /// Counters of the work done by the quad tree operations.
+    /// </summary>
+    struct qcounters
+    {
+        /// Number of nodes visited by the queries.
+        std::size_t query_nodes = 0;
+        /// Number of elements whose bounds were tested against a query area.
+        std::size_t elements_tested = 0;
+        /// Number of elements returned by the queries.
+        std::size_t elements_returned = 0;
+        /// Number of insertions.
+        std::size_t inserts = 0;
+        /// Number of removals.
+        std::size_t removes = 0;
+        /// Number of nodes visited by the insertions and removals.
+        std::size_t insert_nodes = 0;
+        /// Number of insertions and removals that could not use the Morton code addressing.
+        std::size_t insert_fallbacks = 0;
+    };
+
+    /// <summary>
+    /// Gets the traversal counters of the calling thread, collected only
+    /// if QTREE_ENABLE_STATS is defined. They can be reset by assigning
+    /// a default constructed qcounters.
+    /// </summary>
+    inline qcounters& traversal_counters()
+    {
+        static thread_local qcounters counters;
+        return counters;
+    }
+
+    /// <summary>
+    /// Snapshot of the shape of a quad tree.
+    /// </summary>
+    struct qstats
+    {
+        /// Number of nodes.
+        std::size_t nodes = 0;
+        /// Number of nodes without elements.
+        std::size_t empty_nodes = 0;
+        /// Number of elements.
+        std::size_t elements = 0;
+        /// Greatest number of elements stored by a single node.
+        std::size_t max_bucket = 0;
+        /// Number of elements stored by the nodes of each level, starting from the root.
+        std::vector<std::size_t> level_elements;
+
+        /// <summary>
+        /// Gets the number of elements stored by the root node, because they
+        /// are not completely contained by any of its children.
+        /// </summary>
+        std::size_t root_elements() const
+        {
+            return level_elements.empty() ? 0 : level_elements.front();
+        }
+
+        /// <summary>
+        /// Gets the ratio between the nodes without elements and all the nodes.
+        /// </summary>
+        double empty_ratio() const
+        {
+            return nodes == 0 ? 0 : static_cast<double>(empty_nodes) / nodes;
+        }
+    };
+}
+
+#endif
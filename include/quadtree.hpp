@@ -1,10 +1,16 @@
 #ifndef QTREE_QUADTREE_H_
 #define QTREE_QUADTREE_H_
 
-#include "qnode.hpp"
+#include "morton.hpp"
+#include "ntree.hpp"
+#include "rect.hpp"
+#include "sweep.hpp"
 
+#include <algorithm>
 #include <array>
-#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
 
 namespace qtree
 {
@@ -54,199 +60,173 @@ namespace qtree
         }
     }
 
-    template<typename TElement, typename TCoordinate, std::size_t Depth>
-    class quadtree : public qnode<TElement, TCoordinate>
+    /// <summary>
+    /// Gets the location of the child node addressed by the given pair of Morton
+    /// code bits (the x bit in the lowest position, the y bit in the highest).
+    /// </summary>
+    constexpr std::size_t morton_child(std::uint64_t bits)
     {
-        /// The parent node can access these private members.
-        friend class quadtree<TElement, TCoordinate, Depth + 1>;
+        return bits == 0 ? NorthWest() : bits == 1 ? NorthEast() : bits == 2 ? SouthWest() : SouthEast();
+    }
 
-        /// This node children will be created in the heap store (in order to avoid
-        /// possible stack overflow for high levels of depth).
-        using TNodePtr = std::unique_ptr<quadtree<TElement, TCoordinate, Depth - 1>>;
+    /// <summary>
+    /// Gets the bounds of a quad tree child node in the given position (North-West,
+    /// North-East, South-East, South-West), known only at run time.
+    /// </summary>
+    /// <param name="parentBounds">Bounds of the parent quad tree node.</param>
+    /// <param name="location">Position of the child node.</param>
+    template<typename TCoordinate>
+    rect<TCoordinate> child_bounds(const rect<TCoordinate>& parentBounds, std::size_t location)
+    {
+        switch (location)
+        {
+        case NorthWest():
+            return child_bounds<TCoordinate, NorthWest()>(parentBounds);
+        case NorthEast():
+            return child_bounds<TCoordinate, NorthEast()>(parentBounds);
+        case SouthEast():
+            return child_bounds<TCoordinate, SouthEast()>(parentBounds);
+        default:
+            return child_bounds<TCoordinate, SouthWest()>(parentBounds);
+        }
+    }
 
+    /// <summary>
+    /// Gets the Morton code of the top-left cell of the deepest level covered by the
+    /// given bounds, and the number of levels to go down from the given node to reach
+    /// the deepest node that completely contains them (computed from the XOR of the
+    /// Morton codes of the bounds corners).
+    /// </summary>
+    /// <param name="node">Bounds of the node, that must contain the given bounds.</param>
+    /// <param name="bounds">Bounds to locate.</param>
+    /// <param name="depth">Depth of the node.</param>
+    template<typename TCoordinate>
+    std::pair<std::uint64_t, std::size_t> morton_locate(const rect<TCoordinate>& node,
+        const rect<TCoordinate>& bounds, std::size_t depth)
+    {
+        const auto right = morton_cell(bounds.right, node.left, node.right, depth, true);
+        const auto bottom = morton_cell(bounds.bottom, node.top, node.bottom, depth, true);
+        // degenerate bounds lying on a cells border belong to the top-left one
+        const auto left = std::min(morton_cell(bounds.left, node.left, node.right, depth, false), right);
+        const auto top = std::min(morton_cell(bounds.top, node.top, node.bottom, depth, false), bottom);
+
+        const auto code = morton_encode(left, top);
+        return std::make_pair(code, morton_shared_levels(code ^ morton_encode(right, bottom), depth));
+    }
 
-    public:
+    /// <summary>
+    /// Gets the bounds of a new quad tree root, twice as wide and tall as the given node
+    /// and extended towards the given bounds, together with the location of the node
+    /// inside the new root.
+    /// </summary>
+    /// <param name="node">Bounds of the current root.</param>
+    /// <param name="bounds">Bounds the new root has to get closer to.</param>
+    /// <param name="grown">Bounds of the new root and location of the node, set only on success.</param>
+    /// <returns>Returns true only if the bounds of the new root can be represented by the
+    /// coordinate type, otherwise returns false.</returns>
+    template<typename TCoordinate>
+    bool grow_bounds(const rect<TCoordinate>& node, const rect<TCoordinate>& bounds,
+        std::pair<rect<TCoordinate>, std::size_t>& grown)
+    {
+        const bool west = bounds.left < node.left;
+        const bool north = bounds.top < node.top;
 
-        /// <summary>
-        /// Initializes the instance with the given bounds.
-        /// </summary>
-        /// <param name="bounds">Quad tree bounds.</param>
-        explicit quadtree(rect<TCoordinate> bounds)
-            : qnode<TElement, TCoordinate>(std::move(bounds))
-        {
-            init_children();
-        }
+        TCoordinate x;
+        TCoordinate y;
 
-        /// <summary>
-        /// Gets the node depth.
-        /// </summary>
-        constexpr static std::size_t depth()
+        if (!grow_coordinate(node.left, node.right, west, x) || !grow_coordinate(node.top, node.bottom, north, y))
         {
-            return Depth;
+            return false;
         }
 
-        /// <summary>
-        /// Gets the number of elements belonging to this node
-        /// and to all is children nodes.
-        /// </summary>
-        std::size_t size() const override
-        {
-            auto n = qnode<TElement, TCoordinate>::size();
+        const auto location = north
+            ? (west ? SouthEast() : SouthWest())
+            : (west ? NorthEast() : NorthWest());
 
-            for (const auto& child : _children)
-            {
-                n += child->size();
-            }
+        grown = std::make_pair(rect<TCoordinate>(
+            west ? x : node.left,
+            north ? y : node.top,
+            west ? node.right : x,
+            north ? node.bottom : y), location);
 
-            return n;
-        }
+        return true;
+    }
 
-        /// <summary>
-        /// Returns true only if this node is empty and all of its
-        /// children are empty, otherwise returns false.
-        /// </summary>
-        bool empty() const override
-        {
-            return size() == 0;
-        }
+    /// <summary>
+    /// Gets the earliest time when the given moving bounds overlap the target ones
+    /// during the time step.
+    /// </summary>
+    /// <param name="bounds">Moving bounds at time zero.</param>
+    /// <param name="velocity">Horizontal and vertical velocity of the bounds.</param>
+    /// <param name="target">Fixed bounds.</param>
+    /// <param name="duration">Duration of the time step.</param>
+    /// <param name="time">Earliest time of impact, set only on success.</param>
+    /// <returns>Returns true only if the bounds overlap during the time step,
+    /// otherwise returns false.</returns>
+    template<typename TCoordinate>
+    bool sweep_bounds(const rect<TCoordinate>& bounds, const std::array<TCoordinate, 2>& velocity,
+        const rect<TCoordinate>& target, double duration, double& time)
+    {
+        auto interval = sweep_unbounded();
 
-        /// <summary>
-        /// Removes all the element from the quad tree.
-        /// </summary>
-        void clear() override
-        {
-            for (const auto& child : _children)
-            {
-                child->clear();
-            }
+        return sweep_axis(bounds.left, bounds.right, velocity[0], target.left, target.right, interval)
+            && sweep_axis(bounds.top, bounds.bottom, velocity[1], target.top, target.bottom, interval)
+            && sweep_time(interval, duration, time);
+    }
 
-            qnode<TElement, TCoordinate>::clear();
-        }
+    /// <summary>
+    /// Partitioning of the 2D rects by the quad tree nodes.
+    /// </summary>
+    template<typename TCoordinate>
+    struct bounds_traits<rect<TCoordinate>>
+    {
+        using coordinate = TCoordinate;
+        using vector = std::array<TCoordinate, 2>;
+
+        constexpr static std::size_t dimensions() { return 2; }
+        constexpr static std::size_t children() { return 4; }
 
-        /// <summary>
-        /// Insert the given element into the quad tree.
-        /// </summary>
-        /// <param name="element">Element to be inserted.</param>
-        /// <param name="bounds">Element bounds.</param>
-        /// <returns>Returns true only if the element has been inserted,
-        /// otherwise returns false.</returns>
-        bool insert(TElement element, rect<TCoordinate> bounds) override
+        template<std::size_t Location>
+        static rect<TCoordinate> child(const rect<TCoordinate>& parentBounds)
         {
-            if (!this->contains(bounds))
-            {
-                // the given element cannot be contained by this node
-                return false;
-            }
-
-            for (const auto& child : _children)
-            {
-                if (child->contains(bounds))
-                {
-                    return child->insert(std::move(element), std::move(bounds));
-                }
-            }
-
-            // at this point none of the children completely contained the item.
-            // add the element to this node.
-            return qnode<TElement, TCoordinate>::insert(std::move(element), std::move(bounds));
+            return child_bounds<TCoordinate, Location>(parentBounds);
         }
 
-        /// <summary>
-        /// Gets all the elements of the quad tree.
-        /// </summary>
-        /// <param name="elements">References to the elements of this quad tree.</param>
-        void query(typename qnode<TElement, TCoordinate>::TElementRefContainer& elements) const override
+        static rect<TCoordinate> child(const rect<TCoordinate>& parentBounds, std::size_t location)
         {
-            for (const auto& child : _children)
-            {
-                child->query(elements);
-            }
-
-            qnode<TElement, TCoordinate>::query(elements);
+            return child_bounds(parentBounds, location);
         }
 
-        /// <summary>
-        /// Gets all the elements of the node that intersect the given area.
-        /// </summary>
-        /// <param name="area">Area to overlaps.</param>
-        /// <param name="elements">References to the elements of this node that intersect
-        /// the given area.</param>
-        void query(const rect<TCoordinate>& area, typename qnode<TElement, TCoordinate>::TElementRefContainer& elements) const override
+        static std::size_t morton_child(std::uint64_t bits)
         {
-            // this node may contain items that are not entirely contained by its children
-            qnode<TElement, TCoordinate>::query(area, elements);
-
-            for (const auto& child : _children)
-            {
-                // case 1: search area completely contained by child node
-                // if a node completely contains the query area, go down that branch
-                // and skip the remaining nodes
-                if (child->contains(area))
-                {
-                    child->query(area, elements);
-                    break;
-                }
-
-                // case 2: Child node completely contained by search area 
-                // if the query area completely contains a child node,
-                // add all the contents of that quad and its children.
-                if (child->inside(area))
-                {
-                    child->query(elements);
-                    continue;
-                }
-
-                // case 3: search area overlaps with child node
-                // traverse into this quad, continue the loop to search other quads
-                if (child->overlaps(area))
-                {
-                    child->query(area, elements);
-                }
-            }
+            return qtree::morton_child(bits);
         }
 
-
-    private:
-
-        /// <summary>
-        /// Initializes the all the children nodes, according to the quad tree depth.
-        /// </summary>
-        void init_children()
+        static std::pair<std::uint64_t, std::size_t> locate(const rect<TCoordinate>& node,
+            const rect<TCoordinate>& bounds, std::size_t depth)
         {
-            const auto bounds = this->get_bounds();
-
-            _children[NorthWest()].reset(
-                new quadtree<TElement, TCoordinate, Depth - 1>(child_bounds<TCoordinate, NorthWest()>(bounds)));
-
-            _children[NorthEast()].reset(
-                new quadtree<TElement, TCoordinate, Depth - 1>(child_bounds<TCoordinate, NorthEast()>(bounds)));
-
-            _children[SouthEast()].reset(
-                new quadtree<TElement, TCoordinate, Depth - 1>(child_bounds<TCoordinate, SouthEast()>(bounds)));
-
-            _children[SouthWest()].reset(
-                new quadtree<TElement, TCoordinate, Depth - 1>(child_bounds<TCoordinate, SouthWest()>(bounds)));
+            return morton_locate(node, bounds, depth);
         }
 
-        std::array<TNodePtr, 4> _children;
-    };
+        static bool grow(const rect<TCoordinate>& node, const rect<TCoordinate>& bounds,
+            std::pair<rect<TCoordinate>, std::size_t>& grown)
+        {
+            return grow_bounds(node, bounds, grown);
+        }
 
-    /* quadtree template specialization for Depth 0. */
-    template<typename TElement, typename TCoordinate>
-    class quadtree<TElement, TCoordinate, 0> : public qnode<TElement, TCoordinate>
-    {
-        /// The parent node can access these private members.
-        friend class quadtree<TElement, TCoordinate, 1>;
-
-        /// <summary>
-        /// Initializes the instance with the given bounds.
-        /// </summary>
-        /// <param name="bounds">Quad tree bounds.</param>
-        constexpr explicit quadtree(rect<TCoordinate> bounds)
-            : qnode<TElement, TCoordinate>(std::move(bounds))
+        static bool sweep(const rect<TCoordinate>& bounds, const vector& velocity,
+            const rect<TCoordinate>& target, double duration, double& time)
         {
+            return sweep_bounds(bounds, velocity, target, duration, time);
         }
     };
+
+    /// <summary>
+    /// Tree where each internal node has exactly four children, partitioning
+    /// the 2D space of its bounds into four quadrants.
+    /// </summary>
+    template<typename TElement, typename TCoordinate, std::size_t Depth, typename TAggregate = void, bool Epochs = false>
+    using quadtree = ntree<TElement, rect<TCoordinate>, Depth, TAggregate, Epochs>;
 }
 
 #endif
@@ -0,0 +1,427 @@
+#ifndef QTREE_QVIEW_H_
+#define QTREE_QVIEW_H_
+
+#include "qformat.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace qtree
+{
+    /// <summary>
+    /// Read-only quad tree that queries directly a serialized quad tree (see serialize),
+    /// without copying nor deserializing it.
+    /// </summary>
+    /// <remarks>The memory the view refers to must outlive the view.</remarks>
+    template<typename TElement, typename TCoordinate>
+    class qview
+    {
+        using TRecord = qrecord<TElement, TCoordinate>;
+
+    public:
+
+        /// Vector of references to the view items.
+        using TElementRefContainer = std::vector<std::reference_wrapper<const TElement>>;
+
+        /// <summary>
+        /// Initializes the instance with the given serialized quad tree.
+        /// Throws std::invalid_argument if the data is not a valid serialized
+        /// quad tree of the given element and coordinate types.
+        /// </summary>
+        /// <param name="data">Serialized quad tree, aligned to at least the alignment of its
+        /// element records and of 64 bits integers (as memory mapped files are).</param>
+        /// <param name="size">Size in bytes of the serialized quad tree.</param>
+        qview(const void* data, std::size_t size)
+            : _data(static_cast<const char*>(data))
+            , _depth()
+            , _nodes()
+            , _elements()
+            , _bounds()
+            , _entries()
+            , _records()
+        {
+            static_assert(std::is_trivially_copyable<TElement>::value, "The elements must be trivially copyable.");
+
+            qheader header;
+
+            if (size < sizeof(header))
+            {
+                throw std::invalid_argument("Invalid quad tree format.");
+            }
+
+            std::memcpy(&header, _data, sizeof(header));
+
+            if (std::memcmp(header.magic, "QTRE", sizeof(header.magic)) != 0
+                || header.version != qformat_version()
+                || header.byte_order != qformat_byte_order()
+                || header.coordinate_size != sizeof(TCoordinate)
+                || header.record_size != sizeof(TRecord)
+                || header.depth > 30
+                || header.nodes == 0
+                || header.nodes > size / sizeof(qentry)
+                || header.elements > size / sizeof(TRecord))
+            {
+                throw std::invalid_argument("Invalid quad tree format.");
+            }
+
+            const qlayout<TElement, TCoordinate> layout(header.nodes, header.elements);
+
+            if (layout.size > size
+                || reinterpret_cast<std::uintptr_t>(_data) % alignof(TRecord) != 0
+                || reinterpret_cast<std::uintptr_t>(_data) % alignof(qentry) != 0)
+            {
+                throw std::invalid_argument("Invalid quad tree format.");
+            }
+
+            _depth = header.depth;
+            _nodes = header.nodes;
+            _elements = header.elements;
+            std::memcpy(&_bounds, _data + layout.bounds, sizeof(_bounds));
+            _entries = reinterpret_cast<const qentry*>(_data + layout.entries);
+            _records = reinterpret_cast<const TRecord*>(_data + layout.records);
+
+            // the other entries are validated when they are visited, so that opening
+            // a view does not touch the whole mapped memory
+            const auto& root = _entries[_nodes - 1];
+
+            if (root.first != 0 || root.elements != _elements || root.nodes != _nodes)
+            {
+                throw std::invalid_argument("Invalid quad tree format.");
+            }
+        }
+
+        /// <summary>
+        /// Gets the view bounds.
+        /// </summary>
+        rect<TCoordinate> get_bounds() const
+        {
+            return _bounds;
+        }
+
+        /// <summary>
+        /// Gets the depth of the serialized quad tree.
+        /// </summary>
+        std::size_t depth() const
+        {
+            return _depth;
+        }
+
+        /// <summary>
+        /// Gets the number of elements of the view.
+        /// </summary>
+        std::size_t size() const
+        {
+            return static_cast<std::size_t>(_elements);
+        }
+
+        /// <summary>
+        /// Returns true only if the view has no elements, otherwise returns false.
+        /// </summary>
+        bool empty() const
+        {
+            return _elements == 0;
+        }
+
+        /// <summary>
+        /// Gets all the elements of the view.
+        /// </summary>
+        /// <param name="elements">References to the elements of this view.</param>
+        void query(TElementRefContainer& elements) const
+        {
+            query(0, _elements, elements);
+        }
+
+        /// <summary>
+        /// Gets all the elements of the view that intersect the given area.
+        /// </summary>
+        /// <param name="area">Area to overlaps.</param>
+        /// <param name="elements">References to the elements of this view that intersect
+        /// the given area.</param>
+        /// <remarks>Throws std::invalid_argument if one of the visited nodes is not valid.</remarks>
+        void query(const rect<TCoordinate>& area, TElementRefContainer& elements) const
+        {
+            query(_nodes - 1, _depth, _bounds, area, elements);
+        }
+
+
+    private:
+
+        /// <summary>
+        /// Gets all the elements of the given range of records.
+        /// </summary>
+        /// <param name="first">Index of the first record.</param>
+        /// <param name="count">Number of records.</param>
+        /// <param name="elements">References to the elements of the records.</param>
+        void query(std::uint64_t first, std::uint64_t count, TElementRefContainer& elements) const
+        {
+            for (auto i = first; i < first + count; i++)
+            {
+                elements.emplace_back(_records[i].element);
+            }
+        }
+
+        /// <summary>
+        /// Gets the indexes of the entries of the children of the given node, by location
+        /// (the entries count of a node without a child), checking that they are consistent
+        /// with the entry of the node. Throws std::invalid_argument if they are not.
+        /// </summary>
+        /// <param name="node">Index of the entry of the node.</param>
+        /// <param name="depth">Depth of the node.</param>
+        /// <param name="children">Indexes of the entries of the children.</param>
+        void child_entries(std::uint64_t node, std::size_t depth, std::uint64_t (&children)[4]) const
+        {
+            const auto& entry = _entries[node];
+
+            if (entry.nodes == 0 || entry.nodes > node + 1
+                || entry.own > entry.elements
+                || entry.elements > _elements || entry.first > _elements - entry.elements
+                || entry.children > 15 || (depth == 0 && entry.children != 0))
+            {
+                throw std::invalid_argument("Invalid quad tree format.");
+            }
+
+            // the children entries precede the node one, the last child first
+            auto next = node;
+            auto nodes = entry.nodes - 1;
+            auto end = entry.first + entry.elements;
+
+            for (std::size_t i = 4; i-- > 0;)
+            {
+                children[i] = _nodes;
+
+                if ((entry.children & (1u << i)) == 0)
+                {
+                    continue;
+                }
+
+                if (nodes == 0)
+                {
+                    throw std::invalid_argument("Invalid quad tree format.");
+                }
+
+                const auto& child = _entries[--next];
+
+                if (child.nodes == 0 || child.nodes > nodes
+                    || child.elements > end - entry.first - entry.own
+                    || child.first != end - child.elements)
+                {
+                    throw std::invalid_argument("Invalid quad tree format.");
+                }
+
+                children[i] = next;
+                next -= child.nodes - 1;
+                nodes -= child.nodes;
+                end = child.first;
+            }
+
+            if (nodes != 0 || end != entry.first + entry.own)
+            {
+                throw std::invalid_argument("Invalid quad tree format.");
+            }
+        }
+
+        /// <summary>
+        /// Gets all the elements of the given node and of its children that
+        /// intersect the given area.
+        /// </summary>
+        /// <param name="node">Index of the entry of the node.</param>
+        /// <param name="depth">Depth of the node.</param>
+        /// <param name="bounds">Bounds of the node.</param>
+        /// <param name="area">Area to overlaps.</param>
+        /// <param name="elements">References to the elements that intersect the given area.</param>
+        void query(std::uint64_t node, std::size_t depth, const rect<TCoordinate>& bounds,
+            const rect<TCoordinate>& area, TElementRefContainer& elements) const
+        {
+            std::uint64_t indexes[4];
+            child_entries(node, depth, indexes);
+
+            // this node may contain items that are not entirely contained by its children
+            const auto& entry = _entries[node];
+
+            for (auto i = entry.first; i < entry.first + entry.own; i++)
+            {
+                if (area.overlaps(_records[i].bounds))
+                {
+                    elements.emplace_back(_records[i].element);
+                }
+            }
+
+            if (depth == 0)
+            {
+                return;
+            }
+
+            const rect<TCoordinate> children[] = {
+                child_bounds<TCoordinate, NorthWest()>(bounds),
+                child_bounds<TCoordinate, NorthEast()>(bounds),
+                child_bounds<TCoordinate, SouthEast()>(bounds),
+                child_bounds<TCoordinate, SouthWest()>(bounds)
+            };
+
+            for (std::size_t i = 0; i < 4; i++)
+            {
+                const auto& childBounds = children[i];
+
+                // same cases of quadtree::query
+                if (childBounds.contains(area))
+                {
+                    if (indexes[i] != _nodes)
+                    {
+                        query(indexes[i], depth - 1, childBounds, area, elements);
+                    }
+
+                    break;
+                }
+
+                // the children without entries have no elements
+                if (indexes[i] == _nodes)
+                {
+                    continue;
+                }
+
+                // the elements of a whole subtree are contiguous
+                if (area.contains(childBounds))
+                {
+                    const auto& child = _entries[indexes[i]];
+                    query(child.first, child.elements, elements);
+                    continue;
+                }
+
+                if (childBounds.overlaps(area))
+                {
+                    query(indexes[i], depth - 1, childBounds, area, elements);
+                }
+            }
+        }
+
+        const char* _data;
+        std::size_t _depth;
+        std::uint64_t _nodes;
+        std::uint64_t _elements;
+        rect<TCoordinate> _bounds;
+        const qentry* _entries;
+        const TRecord* _records;
+    };
+
+#if defined(__unix__) || defined(__APPLE__)
+    /// <summary>
+    /// Read-only memory mapped file, that can be shared by multiple processes
+    /// through the page cache.
+    /// </summary>
+    class mapped_file
+    {
+    public:
+
+        /// <summary>
+        /// Maps the whole file with the given path.
+        /// Throws std::system_error if the file cannot be mapped.
+        /// </summary>
+        /// <param name="path">Path of the file.</param>
+        explicit mapped_file(const std::string& path)
+            : _data(nullptr)
+            , _size()
+        {
+            const auto fd = ::open(path.c_str(), O_RDONLY);
+
+            if (fd < 0)
+            {
+                throw std::system_error(errno, std::generic_category(), "Unable to open " + path);
+            }
+
+            struct stat info;
+
+            if (::fstat(fd, &info) != 0)
+            {
+                const auto error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "Unable to stat " + path);
+            }
+
+            _size = static_cast<std::size_t>(info.st_size);
+
+            if (_size > 0)
+            {
+                auto data = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+
+                if (data == MAP_FAILED)
+                {
+                    const auto error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "Unable to map " + path);
+                }
+
+                _data = data;
+            }
+
+            // the mapping stays valid after closing the file
+            ::close(fd);
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        mapped_file(mapped_file&& other) noexcept
+            : _data(other._data)
+            , _size(other._size)
+        {
+            other._data = nullptr;
+            other._size = 0;
+        }
+
+        mapped_file& operator=(mapped_file&& other) noexcept
+        {
+            std::swap(_data, other._data);
+            std::swap(_size, other._size);
+            return *this;
+        }
+
+        ~mapped_file() noexcept
+        {
+            if (_data != nullptr)
+            {
+                ::munmap(_data, _size);
+            }
+        }
+
+        /// <summary>
+        /// Gets the mapped memory.
+        /// </summary>
+        const void* data() const noexcept
+        {
+            return _data;
+        }
+
+        /// <summary>
+        /// Gets the size in bytes of the mapped memory.
+        /// </summary>
+        std::size_t size() const noexcept
+        {
+            return _size;
+        }
+
+
+    private:
+
+        void* _data;
+        std::size_t _size;
+    };
+#endif
+}
+
+#endif
@@ -92,10 +92,14 @@ namespace qtree
             return (left < rect.right && right > rect.left && bottom > rect.top && top < rect.bottom) ? true : false;
         }
 
-        const T left;
-        const T top;
-        const T right;
-        const T bottom;
+        /// <remarks>The coordinates are not const, so that rects can be assigned and stored
+        /// in containers compacted in place (such as the node elements, on remove). Assigning
+        /// them directly bypasses the constructor validation: callers must keep right not
+        /// smaller than left and bottom not smaller than top.</remarks>
+        T left;
+        T top;
+        T right;
+        T bottom;
     };
 }
 
@@ -0,0 +1,73 @@
+#ifndef QTREE_SWEEP_H_
+#define QTREE_SWEEP_H_
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace qtree
+{
+    /// <summary>
+    /// Gets the open interval of times with no constraint, to be narrowed by sweep_axis.
+    /// </summary>
+    inline std::pair<double, double> sweep_unbounded()
+    {
+        return std::make_pair(-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+    }
+
+    /// <summary>
+    /// Narrows the given open interval of times to the ones when a moving segment
+    /// overlaps a fixed one along a single axis.
+    /// </summary>
+    /// <param name="lower">Lower coordinate of the moving segment at time zero.</param>
+    /// <param name="upper">Upper coordinate of the moving segment at time zero.</param>
+    /// <param name="speed">Speed of the moving segment along the axis.</param>
+    /// <param name="targetLower">Lower coordinate of the fixed segment.</param>
+    /// <param name="targetUpper">Upper coordinate of the fixed segment.</param>
+    /// <param name="interval">Open interval of times to narrow.</param>
+    /// <returns>Returns true only if the narrowed interval is not empty,
+    /// otherwise returns false.</returns>
+    inline bool sweep_axis(double lower, double upper, double speed,
+        double targetLower, double targetUpper, std::pair<double, double>& interval)
+    {
+        if (speed == 0)
+        {
+            // the overlap along this axis never changes
+            return lower < targetUpper && upper > targetLower && interval.first < interval.second;
+        }
+
+        // times when the moving segment starts and stops overlapping
+        auto enter = (targetLower - upper) / speed;
+        auto exit = (targetUpper - lower) / speed;
+
+        if (speed < 0)
+        {
+            std::swap(enter, exit);
+        }
+
+        interval.first = std::max(interval.first, enter);
+        interval.second = std::min(interval.second, exit);
+        return interval.first < interval.second;
+    }
+
+    /// <summary>
+    /// Gets the earliest time of the given overlap interval within the time step.
+    /// </summary>
+    /// <param name="interval">Open interval of times of the overlap.</param>
+    /// <param name="duration">Duration of the time step, starting from zero.</param>
+    /// <param name="time">Earliest time of impact, set only on success.</param>
+    /// <returns>Returns true only if the overlap happens during the time step,
+    /// otherwise returns false.</returns>
+    inline bool sweep_time(const std::pair<double, double>& interval, double duration, double& time)
+    {
+        if (!(interval.first < interval.second && interval.second > 0 && interval.first < duration))
+        {
+            return false;
+        }
+
+        time = std::max(interval.first, 0.0);
+        return true;
+    }
+}
+
+#endif
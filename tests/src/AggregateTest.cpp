@@ -0,0 +1,261 @@
+#include "quadtree.hpp"
+using namespace qtree;
+
+#include "gtest/gtest.h"
+using namespace testing;
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using TCoordinate = float;
+    using TElement = int;
+    using TRect = rect<TCoordinate>;
+
+    /// Sum of the elements values.
+    struct sum_aggregate
+    {
+        using value_type = long;
+
+        static value_type identity() { return 0; }
+        static value_type value(const TElement& element, const TRect&) { return element; }
+        static value_type combine(value_type lhs, value_type rhs) { return lhs + rhs; }
+    };
+
+    /// Smallest left and greatest right coordinates of the elements bounds.
+    struct extent_aggregate
+    {
+        using value_type = std::pair<TCoordinate, TCoordinate>;
+
+        static value_type identity()
+        {
+            return value_type(std::numeric_limits<TCoordinate>::max(), std::numeric_limits<TCoordinate>::lowest());
+        }
+
+        static value_type value(const TElement&, const TRect& bounds)
+        {
+            return value_type(bounds.left, bounds.right);
+        }
+
+        static value_type combine(const value_type& lhs, const value_type& rhs)
+        {
+            return value_type(std::min(lhs.first, rhs.first), std::max(lhs.second, rhs.second));
+        }
+    };
+
+    /// Count of the elements that also counts the element summaries computed.
+    struct scanned_aggregate
+    {
+        using value_type = std::size_t;
+
+        static std::size_t& scanned()
+        {
+            static std::size_t scanned = 0;
+            return scanned;
+        }
+
+        static value_type identity() { return 0; }
+        static value_type value(const TElement&, const TRect&) { scanned()++; return 1; }
+        static value_type combine(value_type lhs, value_type rhs) { return lhs + rhs; }
+    };
+
+    template<typename TQuadTree>
+    class AggregateTest : public Test
+    {
+    protected:
+
+        using TElementsContainer = typename qnode<TElement, TCoordinate>::TElementRefContainer;
+
+        AggregateTest()
+            : _bounds(0, 0, 64, 64)
+            , _quadtree(_bounds)
+        {
+            std::mt19937 generator(7);
+            std::uniform_real_distribution<TCoordinate> position(0, 60);
+            std::uniform_real_distribution<TCoordinate> size(0.5f, 4);
+
+            for (TElement i = 0; i < 300; i++)
+            {
+                const auto x = position(generator);
+                const auto y = position(generator);
+                _elements.emplace_back(i, TRect(x, y, x + size(generator), y + size(generator)));
+            }
+        }
+
+        void insertAll()
+        {
+            for (const auto& e : _elements)
+            {
+                ASSERT_TRUE(_quadtree.insert(e.first, e.second));
+            }
+        }
+
+        /// Aggregates the elements returned by the area query.
+        template<typename TAggregate>
+        typename TAggregate::value_type expected(const TRect& area) const
+        {
+            TElementsContainer elements;
+            _quadtree.query(area, elements);
+
+            auto summary = TAggregate::identity();
+
+            for (const auto& e : _elements)
+            {
+                const auto found = std::find_if(elements.begin(), elements.end(),
+                    [&e](const TElement& element) { return element == e.first; });
+
+                if (found != elements.end())
+                {
+                    summary = TAggregate::combine(summary, TAggregate::value(e.first, e.second));
+                }
+            }
+
+            return summary;
+        }
+
+        std::vector<TRect> areas() const
+        {
+            return {
+                _bounds,
+                TRect(0, 0, 32, 32),
+                TRect(10, 10, 50, 40),
+                TRect(31, 31, 33, 33),
+                TRect(1, 60, 63, 63),
+                TRect(100, 100, 101, 101)
+            };
+        }
+
+        const TRect _bounds;
+        std::vector<std::pair<TElement, TRect>> _elements;
+
+        TQuadTree _quadtree;
+    };
+
+    template<typename TQuadTree>
+    class CountAggregateTest : public AggregateTest<TQuadTree>
+    {
+    };
+
+    using CountAggregateTypes = Types<
+        quadtree<TElement, TCoordinate, 1, count_aggregate>,
+        quadtree<TElement, TCoordinate, 3, count_aggregate>,
+        quadtree<TElement, TCoordinate, 5, count_aggregate>>;
+
+    TYPED_TEST_CASE(CountAggregateTest, CountAggregateTypes);
+
+    template<typename TQuadTree>
+    class SumAggregateTest : public AggregateTest<TQuadTree>
+    {
+    };
+
+    using SumAggregateTypes = Types<
+        quadtree<TElement, TCoordinate, 1, sum_aggregate>,
+        quadtree<TElement, TCoordinate, 4, sum_aggregate>>;
+
+    TYPED_TEST_CASE(SumAggregateTest, SumAggregateTypes);
+}
+
+
+TYPED_TEST(CountAggregateTest, ShouldCountTheElementsOfTheArea)
+{
+    ASSERT_EQ(0u, this->_quadtree.summary());
+    ASSERT_EQ(0u, this->_quadtree.aggregate(this->_bounds));
+
+    this->insertAll();
+    ASSERT_EQ(this->_elements.size(), this->_quadtree.summary());
+
+    for (const auto& area : this->areas())
+    {
+        typename TestFixture::TElementsContainer elements;
+        this->_quadtree.query(area, elements);
+        ASSERT_EQ(elements.size(), this->_quadtree.aggregate(area));
+    }
+}
+
+TYPED_TEST(CountAggregateTest, ShouldUpdateTheSummariesOnRemoveAndClear)
+{
+    this->insertAll();
+
+    for (std::size_t i = 0; i < this->_elements.size(); i += 3)
+    {
+        ASSERT_TRUE(this->_quadtree.remove(this->_elements[i].first, this->_elements[i].second));
+    }
+
+    ASSERT_EQ(this->_quadtree.size(), this->_quadtree.summary());
+
+    for (const auto& area : this->areas())
+    {
+        typename TestFixture::TElementsContainer elements;
+        this->_quadtree.query(area, elements);
+        ASSERT_EQ(elements.size(), this->_quadtree.aggregate(area));
+    }
+
+    this->_quadtree.clear();
+    ASSERT_EQ(0u, this->_quadtree.summary());
+    ASSERT_EQ(0u, this->_quadtree.aggregate(this->_bounds));
+}
+
+TYPED_TEST(SumAggregateTest, ShouldSumTheElementsOfTheArea)
+{
+    this->insertAll();
+
+    for (const auto& area : this->areas())
+    {
+        ASSERT_EQ(this->template expected<sum_aggregate>(area), this->_quadtree.aggregate(area));
+    }
+
+    // removing an element that does not exist leaves the summaries unchanged
+    const auto total = this->_quadtree.summary();
+    ASSERT_FALSE(this->_quadtree.remove(1000, TRect(1, 1, 2, 2)));
+    ASSERT_EQ(total, this->_quadtree.summary());
+
+    ASSERT_TRUE(this->_quadtree.remove(this->_elements[10].first, this->_elements[10].second));
+    ASSERT_EQ(total - this->_elements[10].first, this->_quadtree.summary());
+}
+
+TEST(ExtentAggregateTest, ShouldRecomputeMinMaxOnRemove)
+{
+    quadtree<TElement, TCoordinate, 3, extent_aggregate> tree(TRect(0, 0, 64, 64));
+
+    ASSERT_TRUE(tree.insert(1, TRect(2, 2, 3, 3)));
+    ASSERT_TRUE(tree.insert(2, TRect(10, 2, 40, 3)));
+    ASSERT_TRUE(tree.insert(3, TRect(50, 50, 60, 51)));
+
+    ASSERT_EQ(extent_aggregate::value_type(2, 60), tree.summary());
+    ASSERT_EQ(extent_aggregate::value_type(2, 40), tree.aggregate(TRect(0, 0, 32, 32)));
+
+    ASSERT_TRUE(tree.remove(1, TRect(2, 2, 3, 3)));
+    ASSERT_TRUE(tree.remove(3, TRect(50, 50, 60, 51)));
+
+    ASSERT_EQ(extent_aggregate::value_type(10, 40), tree.summary());
+    ASSERT_EQ(extent_aggregate::identity(), tree.aggregate(TRect(41, 41, 64, 64)));
+}
+
+TEST(ScannedAggregateTest, ShouldScanOnlyTheNodeOfTheRemovedElement)
+{
+    quadtree<TElement, TCoordinate, 4, scanned_aggregate> tree(TRect(0, 0, 64, 64));
+
+    // elements crossing the center are held by the root
+    for (TElement i = 0; i < 100; i++)
+    {
+        ASSERT_TRUE(tree.insert(i, TRect(30, 30, 34, 34)));
+    }
+
+    ASSERT_TRUE(tree.insert(100, TRect(1, 1, 2, 2)));
+    ASSERT_TRUE(tree.insert(101, TRect(1, 1, 2, 2)));
+
+    scanned_aggregate::scanned() = 0;
+    ASSERT_TRUE(tree.remove(100, TRect(1, 1, 2, 2)));
+
+    // only the remaining element of the deepest node is summarized again
+    ASSERT_EQ(1u, scanned_aggregate::scanned());
+    ASSERT_EQ(101u, tree.summary());
+    ASSERT_EQ(1u, tree.aggregate(TRect(0, 0, 16, 16)));
+
+    ASSERT_TRUE(tree.remove(0, TRect(30, 30, 34, 34)));
+    ASSERT_EQ(100u, tree.summary());
+}
@@ -0,0 +1,87 @@
+#include "box.hpp"
+
+#include "gtest/gtest.h"
+using namespace testing;
+
+namespace
+{
+    template<typename T>
+    class BoxTest : public Test
+    {
+    protected:
+
+        using TBox = qtree::box<T, 3>;
+
+        const TBox _zeroBox;
+    };
+
+    using BoxElementT = Types<int, unsigned, long long, float, double>;
+
+    TYPED_TEST_CASE(BoxTest, BoxElementT);
+}
+
+TYPED_TEST(BoxTest, ShouldBeZeroInitializedByDefault)
+{
+    for (std::size_t i = 0; i < TestFixture::TBox::dimensions(); i++)
+    {
+        EXPECT_EQ(0, this->_zeroBox.lower[i]);
+        EXPECT_EQ(0, this->_zeroBox.upper[i]);
+        EXPECT_EQ(0, this->_zeroBox.extent(i));
+    }
+}
+
+TYPED_TEST(BoxTest, ShouldBeInitializedByValues)
+{
+    const typename TestFixture::TBox box({ 1, 2, 3 }, { 4, 6, 8 });
+
+    EXPECT_EQ(1, box.lower[0]);
+    EXPECT_EQ(2, box.lower[1]);
+    EXPECT_EQ(3, box.lower[2]);
+    EXPECT_EQ(3, box.extent(0));
+    EXPECT_EQ(4, box.extent(1));
+    EXPECT_EQ(5, box.extent(2));
+}
+
+TYPED_TEST(BoxTest, ShouldCompare)
+{
+    const typename TestFixture::TBox box({ 1, 2, 3 }, { 4, 6, 8 });
+
+    EXPECT_EQ(typename TestFixture::TBox(), this->_zeroBox);
+    EXPECT_NE(box, this->_zeroBox);
+    EXPECT_EQ(box, box);
+}
+
+TYPED_TEST(BoxTest, ShouldThrowWhenCoordinateIsInvalid)
+{
+    using TBox = typename TestFixture::TBox;
+
+    EXPECT_THROW(TBox({ 2, 1, 1 }, { 1, 2, 2 }), std::invalid_argument);
+    EXPECT_THROW(TBox({ 1, 2, 1 }, { 2, 1, 2 }), std::invalid_argument);
+    EXPECT_THROW(TBox({ 1, 1, 2 }, { 2, 2, 1 }), std::invalid_argument);
+}
+
+TYPED_TEST(BoxTest, ShouldContainAndOverlap)
+{
+    using TBox = typename TestFixture::TBox;
+    const TBox box({ 10, 10, 10 }, { 20, 20, 20 });
+
+    EXPECT_TRUE(this->_zeroBox.contains(TBox()));
+    EXPECT_TRUE(box.contains(box));
+    EXPECT_TRUE(box.overlaps(box));
+
+    const TBox inner({ 12, 15, 19 }, { 13, 20, 20 });
+    EXPECT_TRUE(box.contains(inner));
+    EXPECT_FALSE(inner.contains(box));
+    EXPECT_TRUE(box.overlaps(inner));
+    EXPECT_TRUE(inner.overlaps(box));
+
+    // crossing a single face
+    const TBox crossing({ 15, 15, 19 }, { 16, 16, 21 });
+    EXPECT_FALSE(box.contains(crossing));
+    EXPECT_TRUE(box.overlaps(crossing));
+
+    // touching a single face
+    const TBox touching({ 15, 15, 20 }, { 16, 16, 21 });
+    EXPECT_FALSE(box.overlaps(touching));
+    EXPECT_FALSE(touching.overlaps(box));
+}
@@ -0,0 +1,231 @@
+#include "expanding.hpp"
+using namespace qtree;
+
+#include "gtest/gtest.h"
+using namespace testing;
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    using TCoordinate = float;
+    using TElement = int;
+    using TRect = rect<TCoordinate>;
+
+    template<typename TTree>
+    class ExpandingTest : public Test
+    {
+    protected:
+
+        using TElementsContainer = typename TTree::TElementRefContainer;
+
+        ExpandingTest()
+            : _bounds(0, 0, 16, 16)
+            , _tree(_bounds)
+        {
+        }
+
+        static std::vector<TElement> sorted(const TElementsContainer& elements)
+        {
+            std::vector<TElement> values(elements.begin(), elements.end());
+            std::sort(values.begin(), values.end());
+            return values;
+        }
+
+        const TRect _bounds;
+
+        TTree _tree;
+    };
+
+    using ExpandingTypes = Types<
+        expanding_quadtree<TElement, TCoordinate, 1>,
+        expanding_quadtree<TElement, TCoordinate, 2>,
+        expanding_quadtree<TElement, TCoordinate, 4>>;
+
+    TYPED_TEST_CASE(ExpandingTest, ExpandingTypes);
+}
+
+
+TYPED_TEST(ExpandingTest, ShouldKeepBoundsWhenInsertingInside)
+{
+    ASSERT_TRUE(this->_tree.insert(1, TRect(1, 1, 2, 2)));
+    ASSERT_TRUE(this->_tree.insert(2, this->_bounds));
+
+    ASSERT_EQ(this->_bounds, this->_tree.get_bounds());
+    ASSERT_EQ(0u, this->_tree.levels());
+    ASSERT_EQ(2u, this->_tree.size());
+}
+
+TYPED_TEST(ExpandingTest, ShouldGrowTowardsTheElements)
+{
+    ASSERT_TRUE(this->_tree.insert(1, TRect(20, 20, 21, 21)));
+    ASSERT_EQ(1u, this->_tree.levels());
+    ASSERT_EQ(TRect(0, 0, 32, 32), this->_tree.get_bounds());
+
+    ASSERT_TRUE(this->_tree.insert(2, TRect(-1, 5, 0, 6)));
+    ASSERT_EQ(2u, this->_tree.levels());
+    ASSERT_EQ(TRect(-32, 0, 32, 64), this->_tree.get_bounds());
+
+    // more than one root is added at once when the element is far away
+    ASSERT_TRUE(this->_tree.insert(3, TRect(-200, -200, -199, -199)));
+    ASSERT_EQ(5u, this->_tree.levels());
+    ASSERT_EQ(TRect(-224, -448, 288, 64), this->_tree.get_bounds());
+
+    ASSERT_EQ(3u, this->_tree.size());
+
+    typename TestFixture::TElementsContainer elements;
+    this->_tree.query(elements);
+    ASSERT_EQ((std::vector<TElement>{ 1, 2, 3 }), this->sorted(elements));
+}
+
+TYPED_TEST(ExpandingTest, ShouldQueryAreaAcrossLevels)
+{
+    std::vector<TRect> bounds;
+    TElement element = 0;
+
+    for (TCoordinate x = -40; x < 56; x += 3)
+    {
+        for (TCoordinate y = -24; y < 40; y += 5)
+        {
+            bounds.emplace_back(x, y, x + 2, y + 1 + (element % 7));
+            ASSERT_TRUE(this->_tree.insert(element++, bounds.back()));
+        }
+    }
+
+    ASSERT_EQ(bounds.size(), this->_tree.size());
+    ASSERT_LT(0u, this->_tree.levels());
+
+    const TRect areas[] = {
+        TRect(0, 0, 16, 16),
+        TRect(-10, -10, 2, 30),
+        TRect(-100, -100, 100, 100),
+        TRect(17, 3, 18, 4),
+        this->_tree.get_bounds()
+    };
+
+    for (const auto& area : areas)
+    {
+        std::vector<TElement> expected;
+
+        for (std::size_t i = 0; i < bounds.size(); i++)
+        {
+            if (area.overlaps(bounds[i]))
+            {
+                expected.push_back(static_cast<TElement>(i));
+            }
+        }
+
+        typename TestFixture::TElementsContainer elements;
+        this->_tree.query(area, elements);
+        ASSERT_EQ(expected, this->sorted(elements));
+    }
+}
+
+TYPED_TEST(ExpandingTest, ShouldRemoveAndClear)
+{
+    ASSERT_TRUE(this->_tree.insert(1, TRect(1, 1, 2, 2)));
+    ASSERT_TRUE(this->_tree.insert(2, TRect(20, 1, 30, 2)));
+    ASSERT_TRUE(this->_tree.insert(3, TRect(10, 1, 30, 2)));
+
+    ASSERT_FALSE(this->_tree.remove(2, TRect(20, 1, 30, 3)));
+    ASSERT_FALSE(this->_tree.remove(4, TRect(100, 100, 101, 101)));
+    ASSERT_TRUE(this->_tree.remove(2, TRect(20, 1, 30, 2)));
+    ASSERT_TRUE(this->_tree.remove(3, TRect(10, 1, 30, 2)));
+    ASSERT_FALSE(this->_tree.remove(3, TRect(10, 1, 30, 2)));
+    ASSERT_EQ(1u, this->_tree.size());
+
+    const auto bounds = this->_tree.get_bounds();
+    this->_tree.clear();
+
+    ASSERT_TRUE(this->_tree.empty());
+    ASSERT_EQ(bounds, this->_tree.get_bounds());
+}
+
+TYPED_TEST(ExpandingTest, ShouldNotGrowEmptyBounds)
+{
+    TypeParam tree(TRect(0, 0, 0, 0));
+
+    ASSERT_FALSE(tree.insert(1, TRect(1, 1, 2, 2)));
+    ASSERT_EQ(0u, tree.levels());
+    ASSERT_TRUE(tree.empty());
+}
+
+TEST(ExpandingOctreeTest, ShouldGrowTowardsTheElements)
+{
+    using TBox = box<TCoordinate, 3>;
+    expanding_octree<TElement, TCoordinate, 2> tree(TBox({ 0, 0, 0 }, { 8, 8, 8 }));
+
+    ASSERT_TRUE(tree.insert(1, TBox({ 1, 1, 1 }, { 2, 2, 2 })));
+    ASSERT_TRUE(tree.insert(2, TBox({ 1, 1, -3 }, { 2, 2, -2 })));
+
+    ASSERT_EQ(1u, tree.levels());
+    ASSERT_EQ(TBox({ 0, 0, -8 }, { 16, 16, 8 }), tree.get_bounds());
+
+    expanding_octree<TElement, TCoordinate, 2>::TElementRefContainer elements;
+    tree.query(TBox({ 0, 0, -4 }, { 4, 4, 0 }), elements);
+
+    ASSERT_EQ(1u, elements.size());
+    ASSERT_EQ(2, elements.front());
+}
+
+TEST(ExpandingTest, ShouldCreateShallowerSiblings)
+{
+    using TTree = expanding_quadtree<TElement, TCoordinate, 10>;
+    static_assert(TTree::sibling_depth() == 4, "The siblings of a deep tree should be shallower.");
+    static_assert(expanding_quadtree<TElement, TCoordinate, 10, 2>::sibling_depth() == 2, "");
+
+    TTree tree(TRect(0, 0, 16, 16));
+    ASSERT_TRUE(tree.insert(1, TRect(1, 1, 2, 2)));
+    ASSERT_TRUE(tree.insert(2, TRect(20, 20, 20.5f, 20.5f)));
+    ASSERT_TRUE(tree.insert(3, TRect(17, 1, 18, 2)));
+    ASSERT_EQ(1u, tree.levels());
+
+    TTree::TElementRefContainer elements;
+    tree.query(TRect(16, 0, 32, 32), elements);
+
+    std::vector<TElement> values(elements.begin(), elements.end());
+    std::sort(values.begin(), values.end());
+    ASSERT_EQ((std::vector<TElement>{ 2, 3 }), values);
+
+    ASSERT_TRUE(tree.remove(2, TRect(20, 20, 20.5f, 20.5f)));
+    ASSERT_EQ(2u, tree.size());
+}
+
+TEST(ExpandingTest, ShouldNotRequireEqualityUnlessRemoving)
+{
+    struct plain_element
+    {
+        int value;
+    };
+
+    expanding_quadtree<plain_element, TCoordinate, 2> tree(TRect(0, 0, 16, 16));
+    ASSERT_TRUE(tree.insert({ 1 }, TRect(1, 1, 2, 2)));
+    ASSERT_TRUE(tree.insert({ 2 }, TRect(20, 20, 21, 21)));
+    ASSERT_EQ(1u, tree.levels());
+    ASSERT_EQ(2u, tree.size());
+}
+
+TEST(ExpandingTest, ShouldNotGrowBeyondTheCoordinateLimits)
+{
+    expanding_quadtree<TElement, int, 2> tree(rect<int>(0, 0, 100, 100));
+
+    // each new root doubles the extent, that would overflow before reaching the element
+    ASSERT_FALSE(tree.insert(1, rect<int>(2000000000, 5, 2000000001, 6)));
+    ASSERT_EQ(0u, tree.levels());
+    ASSERT_EQ(rect<int>(0, 0, 100, 100), tree.get_bounds());
+
+    ASSERT_FALSE(tree.insert(2, rect<int>(-2000000000, 5, -1999999999, 6)));
+    ASSERT_EQ(0u, tree.levels());
+
+    // the elements that can be reached are still inserted
+    ASSERT_TRUE(tree.insert(3, rect<int>(1000000000, 5, 1000000001, 6)));
+    ASSERT_EQ(24u, tree.levels());
+    ASSERT_EQ(1u, tree.size());
+
+    // unsigned coordinates cannot go below zero
+    expanding_octree<TElement, unsigned, 2> octree(box<unsigned, 3>({ 5, 10, 10 }, { 20, 20, 20 }));
+    ASSERT_FALSE(octree.insert(4, box<unsigned, 3>({ 0, 10, 10 }, { 1, 11, 11 })));
+    ASSERT_TRUE(octree.insert(5, box<unsigned, 3>({ 25, 10, 10 }, { 26, 11, 11 })));
+    ASSERT_EQ(1u, octree.levels());
+}
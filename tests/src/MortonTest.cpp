@@ -0,0 +1,46 @@
+#include "morton.hpp"
+using namespace qtree;
+
+#include "gtest/gtest.h"
+using namespace testing;
+
+TEST(MortonTest, ShouldEncode)
+{
+    EXPECT_EQ(0u, morton_encode(0, 0));
+    EXPECT_EQ(1u, morton_encode(1, 0));
+    EXPECT_EQ(2u, morton_encode(0, 1));
+    EXPECT_EQ(3u, morton_encode(1, 1));
+    EXPECT_EQ(0x5555555555555555ull, morton_encode(0xFFFFFFFF, 0));
+    EXPECT_EQ(0xAAAAAAAAAAAAAAAAull, morton_encode(0, 0xFFFFFFFF));
+    // x = 0b101, y = 0b011
+    EXPECT_EQ(0x1Bu, morton_encode(5, 3));
+}
+
+TEST(MortonTest, ShouldGetSharedLevels)
+{
+    EXPECT_EQ(4u, morton_shared_levels(0, 4));
+    EXPECT_EQ(3u, morton_shared_levels(morton_encode(2, 2) ^ morton_encode(3, 2), 4));
+    EXPECT_EQ(2u, morton_shared_levels(morton_encode(0, 0) ^ morton_encode(3, 3), 4));
+    EXPECT_EQ(0u, morton_shared_levels(morton_encode(7, 0) ^ morton_encode(8, 0), 4));
+}
+
+TEST(MortonTest, ShouldEncode3D)
+{
+    EXPECT_EQ(1u, morton_encode(1, 0, 0));
+    EXPECT_EQ(2u, morton_encode(0, 1, 0));
+    EXPECT_EQ(4u, morton_encode(0, 0, 1));
+    EXPECT_EQ(0x1249249249249249ull, morton_encode(0x1FFFFF, 0, 0));
+    // x = 0b11, y = 0b01, z = 0b10
+    EXPECT_EQ(0x2Bu, morton_encode(3, 1, 2));
+
+    // the generic encoding matches the specialized ones
+    const std::array<std::uint32_t, 3> cell3 = {{ 12345, 678, 91011 }};
+    const std::array<std::uint32_t, 4> cell4 = {{ 1, 0, 0, 1 }};
+    EXPECT_EQ(morton_encode(12345, 678, 91011), morton_encode(cell3));
+    EXPECT_EQ(0x9u, morton_encode(cell4));
+
+    // a single dimension uses the 32 bits of the coordinate only
+    const std::array<std::uint32_t, 1> cell1 = {{ 0xFFFFFFFFu }};
+    EXPECT_EQ(0xFFFFFFFFull, morton_encode(cell1));
+    EXPECT_EQ(1u, morton_shared_levels(morton_encode(1, 2, 3) ^ morton_encode(0, 2, 3), 2, 3));
+}
@@ -0,0 +1,215 @@
+#include "octree.hpp"
+using namespace qtree;
+
+#include "gtest/gtest.h"
+using namespace testing;
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using TCoordinate = float;
+    using TElement = int;
+    using TBox = box<TCoordinate, 3>;
+
+    template<typename TOctree>
+    class OctreeTest : public Test
+    {
+    protected:
+
+        using TElementsContainer = qnode<TElement, TCoordinate, TBox>::TElementRefContainer;
+
+        OctreeTest()
+            : _bounds({ 0, 0, 0 }, { 16, 16, 16 })
+            , _octree(_bounds)
+        {
+        }
+
+        std::vector<TBox> elementsBounds() const
+        {
+            std::vector<TBox> bounds;
+
+            for (TCoordinate x = 0; x < 16; x += 2)
+            {
+                for (TCoordinate y = 0; y < 16; y += 2)
+                {
+                    for (TCoordinate z = 0; z < 16; z += 2)
+                    {
+                        bounds.emplace_back(TBox::TPoint{ x, y, z }, TBox::TPoint{ x + 1, y + 1, z + 1 });
+                        bounds.emplace_back(TBox::TPoint{ x, y, z },
+                            TBox::TPoint{ std::min<TCoordinate>(x + 5, 16), std::min<TCoordinate>(y + 3, 16), 16 });
+                    }
+                }
+            }
+
+            return bounds;
+        }
+
+        const TBox _bounds;
+
+        TOctree _octree;
+    };
+
+    using OctreeTypes = Types<
+        octree<TElement, TCoordinate, 1>,
+        octree<TElement, TCoordinate, 2>,
+        octree<TElement, TCoordinate, 4>>;
+
+    TYPED_TEST_CASE(OctreeTest, OctreeTypes);
+}
+
+namespace
+{
+    using TSegment = box<TCoordinate, 1>;
+
+    /// <summary>
+    /// One dimensional bounds whose traits provide only the required members.
+    /// </summary>
+    struct segment : TSegment
+    {
+        segment() = default;
+
+        segment(const TSegment& bounds)
+            : TSegment(bounds)
+        {
+        }
+
+        segment(TCoordinate lower, TCoordinate upper)
+            : TSegment({ lower }, { upper })
+        {
+        }
+    };
+}
+
+namespace qtree
+{
+    template<>
+    struct bounds_traits<segment>
+    {
+        using TBase = bounds_traits<TSegment>;
+        using coordinate = TCoordinate;
+
+        constexpr static std::size_t dimensions() { return 1; }
+        constexpr static std::size_t children() { return 2; }
+
+        template<std::size_t Location>
+        static segment child(const segment& parentBounds)
+        {
+            return TBase::child<Location>(parentBounds);
+        }
+
+        static segment child(const segment& parentBounds, std::size_t location)
+        {
+            return TBase::child(parentBounds, location);
+        }
+
+        static std::size_t morton_child(std::uint64_t bits)
+        {
+            return TBase::morton_child(bits);
+        }
+
+        static std::pair<std::uint64_t, std::size_t> locate(const segment& node, const segment& bounds, std::size_t depth)
+        {
+            return TBase::locate(node, bounds, depth);
+        }
+    };
+}
+
+TYPED_TEST(OctreeTest, ShouldGetChildrenBounds)
+{
+    const TBox parent({ 0, 0, 0 }, { 10, 20, 40 });
+
+    const auto lower = child_bounds<TCoordinate, 3, 0>(parent);
+    EXPECT_EQ(TBox({ 0, 0, 0 }, { 5, 10, 20 }), lower);
+
+    const auto upper = child_bounds<TCoordinate, 3, 7>(parent);
+    EXPECT_EQ(TBox({ 5, 10, 20 }, { 10, 20, 40 }), upper);
+
+    // upper half along x and z only
+    const auto mixed = child_bounds<TCoordinate, 3, 5>(parent);
+    EXPECT_EQ(TBox({ 5, 0, 20 }, { 10, 10, 40 }), mixed);
+    EXPECT_EQ(mixed, child_bounds(parent, 5));
+}
+
+TYPED_TEST(OctreeTest, ShouldInsertAndRemove)
+{
+    EXPECT_TRUE(this->_octree.empty());
+    EXPECT_EQ(this->_bounds, this->_octree.get_bounds());
+    EXPECT_FALSE(this->_octree.insert(TElement(), TBox({ 0, 0, 0 }, { 1, 1, 17 })));
+
+    const auto bounds = this->elementsBounds();
+    TElement element{};
+
+    for (const auto& b : bounds)
+    {
+        ASSERT_TRUE(this->_octree.insert(element++, b));
+    }
+
+    ASSERT_EQ(bounds.size(), this->_octree.size());
+    ASSERT_EQ(bounds.size(), this->_octree.stats().elements);
+
+    element = TElement();
+
+    for (const auto& b : bounds)
+    {
+        ASSERT_TRUE(this->_octree.remove(element, b));
+        ASSERT_FALSE(this->_octree.remove(element++, b));
+    }
+
+    ASSERT_TRUE(this->_octree.empty());
+}
+
+TYPED_TEST(OctreeTest, ShouldQueryVolume)
+{
+    const auto bounds = this->elementsBounds();
+    TElement element{};
+
+    for (const auto& b : bounds)
+    {
+        ASSERT_TRUE(this->_octree.insert(element++, b));
+    }
+
+    const TBox volumes[] = {
+        this->_bounds,
+        TBox({ 1, 1, 1 }, { 3, 3, 3 }),
+        TBox({ 0, 8, 4 }, { 16, 9, 12 }),
+        TBox({ 3, 5, 7 }, { 11, 13, 15 })
+    };
+
+    for (const auto& volume : volumes)
+    {
+        typename TestFixture::TElementsContainer elements;
+        this->_octree.query(volume, elements);
+
+        std::vector<TElement> expected;
+        for (std::size_t i = 0; i < bounds.size(); i++)
+        {
+            if (volume.overlaps(bounds[i]))
+            {
+                expected.push_back(static_cast<TElement>(i));
+            }
+        }
+
+        std::vector<TElement> actual(std::begin(elements), std::end(elements));
+        std::sort(std::begin(actual), std::end(actual));
+        ASSERT_EQ(expected, actual);
+    }
+}
+
+TEST(BoundsTraitsTest, ShouldBuildTreeWithTheRequiredMembersOnly)
+{
+    ntree<TElement, segment, 3> tree(segment(0, 8));
+
+    ASSERT_TRUE(tree.insert(1, segment(1, 2)));
+    ASSERT_TRUE(tree.insert(2, segment(3, 5)));
+    ASSERT_TRUE(tree.remove(2, segment(3, 5)));
+
+    ntree<TElement, segment, 3>::TElementRefContainer elements;
+    tree.query(segment(0, 3), elements);
+
+    ASSERT_EQ(1u, elements.size());
+    ASSERT_EQ(1, elements.front());
+}
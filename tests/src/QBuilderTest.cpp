@@ -0,0 +1,255 @@
+#include "qbuilder.hpp"
+#include "qview.hpp"
+using namespace qtree;
+
+#include "gtest/gtest.h"
+using namespace testing;
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using TCoordinate = float;
+    using TElement = int;
+
+    template<typename TQuadTree>
+    class QBuilderTest : public Test
+    {
+    protected:
+
+        using TBuilder = qbuilder<TElement, TCoordinate>;
+
+        QBuilderTest()
+            : _bounds(_left, _top, _right, _bottom)
+            , _qtree(_bounds)
+            , _path("qbuilder-test-" + std::to_string(TQuadTree::depth()) + ".qtree")
+        {
+        }
+
+        ~QBuilderTest()
+        {
+            std::remove(_path.c_str());
+        }
+
+        std::vector<qrecord<TElement, TCoordinate>> records() const
+        {
+            std::vector<qrecord<TElement, TCoordinate>> records;
+            TElement element{};
+            const TCoordinate step = (_right - _left) / 32;
+
+            for (TCoordinate x = _left; x < _right; x += step)
+            {
+                for (TCoordinate y = _top; y < _bottom; y += step)
+                {
+                    records.push_back({ element++, { x, y, x + step / 4, y + step / 4 } });
+                    records.push_back({ element++, { x, y, std::min(x + 3 * step, _right), std::min(y + 5 * step, _bottom) } });
+                }
+            }
+
+            return records;
+        }
+
+        static std::string read(const std::string& path)
+        {
+            std::ifstream in(path, std::ios::binary);
+            return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+
+        std::string serialized() const
+        {
+            std::ostringstream out;
+            EXPECT_TRUE(serialize(_qtree, out));
+            return out.str();
+        }
+
+        const TCoordinate _left = 10;
+        const TCoordinate _top = 10;
+        const TCoordinate _right = 20;
+        const TCoordinate _bottom = 20;
+
+        const rect<TCoordinate> _bounds;
+
+        TQuadTree _qtree;
+        const std::string _path;
+    };
+
+    using QuadTreeTypes = Types<
+        quadtree<TElement, TCoordinate, 1>,
+        quadtree<TElement, TCoordinate, 3>,
+        quadtree<TElement, TCoordinate, 5>>;
+
+    TYPED_TEST_CASE(QBuilderTest, QuadTreeTypes);
+}
+
+TYPED_TEST(QBuilderTest, ShouldBuildEmptyTree)
+{
+    typename QBuilderTest<TypeParam>::TBuilder builder(this->_bounds, TypeParam::depth(), this->_path);
+    ASSERT_EQ(0, builder.size());
+    ASSERT_TRUE(builder.finish());
+    ASSERT_FALSE(builder.finish());
+
+    EXPECT_EQ(this->serialized(), this->read(this->_path));
+}
+
+TYPED_TEST(QBuilderTest, ShouldBuildLikeSerialize)
+{
+    // a small chunk spills many times to the temporary files
+    typename QBuilderTest<TypeParam>::TBuilder builder(this->_bounds, TypeParam::depth(), this->_path, 7);
+    EXPECT_EQ(this->_bounds, builder.get_bounds());
+    EXPECT_EQ(TypeParam::depth(), builder.depth());
+
+    for (const auto& r : this->records())
+    {
+        ASSERT_TRUE(this->_qtree.insert(r.element, r.bounds));
+        ASSERT_TRUE(builder.insert(r.element, r.bounds));
+    }
+
+    ASSERT_FALSE(builder.insert(TElement(), { this->_left - 1, this->_top, this->_right, this->_bottom }));
+    ASSERT_EQ(this->_qtree.size(), builder.size());
+    ASSERT_TRUE(builder.finish());
+    ASSERT_FALSE(builder.insert(TElement(), this->_bounds));
+
+    // the elements of each node keep the insertion order, even when the runs
+    // are merged in groups first
+    EXPECT_EQ(this->serialized(), this->read(this->_path));
+
+    // the temporary files are removed
+    EXPECT_FALSE(std::ifstream(this->_path + ".tmp").is_open());
+    EXPECT_FALSE(std::ifstream(this->_path + ".tmp.merge").is_open());
+}
+
+TYPED_TEST(QBuilderTest, ShouldBuildFromStream)
+{
+    const auto records = this->records();
+    std::stringstream in;
+    in.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(records.front()));
+
+    for (const auto& r : records)
+    {
+        ASSERT_TRUE(this->_qtree.insert(r.element, r.bounds));
+    }
+
+    {
+        typename QBuilderTest<TypeParam>::TBuilder builder(this->_bounds, TypeParam::depth(), this->_path, 100);
+        ASSERT_TRUE(builder.insert(in));
+        ASSERT_EQ(records.size(), builder.size());
+        ASSERT_TRUE(builder.finish());
+    }
+
+    const mapped_file file(this->_path);
+    const qview<TElement, TCoordinate> view(file.data(), file.size());
+    ASSERT_EQ(this->_qtree.size(), view.size());
+
+    EXPECT_EQ(this->serialized(), this->read(this->_path));
+}
+
+TYPED_TEST(QBuilderTest, ShouldFailOnPartialRecord)
+{
+    const auto records = this->records();
+    std::stringstream in;
+    in.write(reinterpret_cast<const char*>(records.data()), 3 * sizeof(records.front()) - 1);
+
+    typename QBuilderTest<TypeParam>::TBuilder builder(this->_bounds, TypeParam::depth(), this->_path);
+    ASSERT_FALSE(builder.insert(in));
+    ASSERT_EQ(2, builder.size());
+    ASSERT_TRUE(builder.finish());
+}
+
+TEST(QBuilderTest, ShouldBuildDeepTree)
+{
+    const std::string path = "qbuilder-test-deep.qtree";
+    const rect<TCoordinate> bounds(0, 0, 1 << 20, 1 << 20);
+    std::vector<rect<TCoordinate>> elements;
+
+    {
+        // the memory does not depend on the number of nodes of the complete tree
+        qbuilder<TElement, TCoordinate> builder(bounds, 24, path, 3);
+
+        for (TCoordinate x = 1; x < (1 << 20); x *= 3)
+        {
+            elements.emplace_back(x, x / 2, x + 0.5f, x / 2 + 0.5f);
+            elements.emplace_back(x, 1, x + x / 2, 2);
+            ASSERT_TRUE(builder.insert(static_cast<TElement>(elements.size() - 2), elements[elements.size() - 2]));
+            ASSERT_TRUE(builder.insert(static_cast<TElement>(elements.size() - 1), elements.back()));
+        }
+
+        ASSERT_TRUE(builder.finish());
+    }
+
+    {
+        const mapped_file file(path);
+        const qview<TElement, TCoordinate> view(file.data(), file.size());
+        ASSERT_EQ(elements.size(), view.size());
+
+        const rect<TCoordinate> areas[] = { bounds, { 0, 0, 100, 100 }, { 500, 0, 800, 1000 } };
+
+        for (const auto& area : areas)
+        {
+            std::vector<TElement> expected;
+
+            for (std::size_t i = 0; i < elements.size(); i++)
+            {
+                if (area.overlaps(elements[i]))
+                {
+                    expected.push_back(static_cast<TElement>(i));
+                }
+            }
+
+            qview<TElement, TCoordinate>::TElementRefContainer found;
+            view.query(area, found);
+
+            std::vector<TElement> actual(found.begin(), found.end());
+            std::sort(actual.begin(), actual.end());
+            ASSERT_EQ(expected, actual);
+        }
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(QBuilderTest, ShouldPlaceIntegerBoundsLikeTheTree)
+{
+    const std::string path = "qbuilder-test-integer.qtree";
+    const rect<int> bounds(0, 0, 1000, 1000);
+    quadtree<TElement, int, 6> tree(bounds);
+
+    {
+        // the children borders are rounded, unlike the Morton cells
+        qbuilder<TElement, int> builder(bounds, 6, path, 50);
+        TElement element = 0;
+
+        for (int x = 0; x < 999; x += 13)
+        {
+            for (int y = 0; y < 999; y += 17)
+            {
+                const rect<int> r(x, y, x + 1, y + 1);
+                ASSERT_TRUE(tree.insert(element, r));
+                ASSERT_TRUE(builder.insert(element++, r));
+            }
+        }
+
+        ASSERT_TRUE(builder.finish());
+    }
+
+    std::ostringstream out;
+    ASSERT_TRUE(serialize(tree, out));
+
+    std::ifstream in(path, std::ios::binary);
+    EXPECT_EQ(out.str(), std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()));
+    in.close();
+
+    std::remove(path.c_str());
+}
+
+TEST(QBuilderTest, ShouldThrowWhenArgumentsAreInvalid)
+{
+    const rect<TCoordinate> bounds(0, 0, 1, 1);
+    EXPECT_THROW((qbuilder<TElement, TCoordinate>(bounds, 31, "qbuilder-test.qtree")), std::invalid_argument);
+    EXPECT_THROW((qbuilder<TElement, TCoordinate>(bounds, 4, "qbuilder-test.qtree", 0)), std::invalid_argument);
+}
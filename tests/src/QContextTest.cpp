@@ -0,0 +1,219 @@
+#include "quadtree.hpp"
+using namespace qtree;
+
+#include "gtest/gtest.h"
+using namespace testing;
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using TCoordinate = float;
+    using TElement = int;
+    using TRect = rect<TCoordinate>;
+    using TContext = qcontext<TElement, TRect>;
+
+    template<typename TQuadTree>
+    class QContextTest : public Test
+    {
+    protected:
+
+        using TElementsContainer = typename qnode<TElement, TCoordinate>::TElementRefContainer;
+
+        QContextTest()
+            : _bounds(0, 0, 128, 128)
+            , _quadtree(_bounds)
+            , _generator(5)
+        {
+            for (TElement i = 0; i < 500; i++)
+            {
+                insert(i);
+            }
+        }
+
+        void insert(TElement element)
+        {
+            std::uniform_real_distribution<TCoordinate> position(0, 120);
+            std::uniform_real_distribution<TCoordinate> size(0.1f, 6);
+
+            const auto x = position(_generator);
+            const auto y = position(_generator);
+            _elements.emplace_back(element, TRect(x, y, x + size(_generator), y + size(_generator)));
+            ASSERT_TRUE(_quadtree.insert(_elements.back().first, _elements.back().second));
+        }
+
+        void remove(std::size_t index)
+        {
+            ASSERT_TRUE(_quadtree.remove(_elements[index].first, _elements[index].second));
+            _elements.erase(_elements.begin() + index);
+        }
+
+        static std::vector<TElement> sorted(const TElementsContainer& elements)
+        {
+            std::vector<TElement> values(elements.begin(), elements.end());
+            std::sort(values.begin(), values.end());
+            return values;
+        }
+
+        /// Queries the area with and without the context.
+        void assertQuery(const TRect& area, TContext& context)
+        {
+            TElementsContainer expected;
+            _quadtree.query(area, expected);
+
+            TElementsContainer elements;
+            _quadtree.query(area, elements, context);
+
+            ASSERT_EQ(sorted(expected), sorted(elements));
+        }
+
+        const TRect _bounds;
+        std::vector<std::pair<TElement, TRect>> _elements;
+
+        TQuadTree _quadtree;
+        std::mt19937 _generator;
+    };
+
+    using QContextTypes = Types<
+        quadtree<TElement, TCoordinate, 1, void, true>,
+        quadtree<TElement, TCoordinate, 3, void, true>,
+        quadtree<TElement, TCoordinate, 5, void, true>>;
+
+    TYPED_TEST_CASE(QContextTest, QContextTypes);
+}
+
+
+TYPED_TEST(QContextTest, ShouldReuseTheResultsOfTheSameArea)
+{
+    TContext context;
+    const TRect area(20, 30, 70, 90);
+
+    this->assertQuery(area, context);
+    ASSERT_EQ(0u, context.reused());
+
+    this->assertQuery(area, context);
+    ASSERT_EQ(1u, context.reused());
+
+    // the element is added to the nodes containing the area
+    ASSERT_TRUE(this->_quadtree.insert(1000, TRect(21, 31, 22, 32)));
+    this->assertQuery(area, context);
+
+    TypeParam other(this->_bounds);
+    ASSERT_TRUE(other.insert(2000, TRect(21, 31, 22, 32)));
+
+    typename TestFixture::TElementsContainer elements;
+    other.query(area, elements, context);
+    ASSERT_EQ((std::vector<TElement>{ 2000 }), this->sorted(elements));
+}
+
+TYPED_TEST(QContextTest, ShouldReuseTheUnchangedSubtrees)
+{
+    TContext context;
+    this->assertQuery(TRect(8, 8, 120, 120), context);
+
+    if (TypeParam::depth() > 1)
+    {
+        ASSERT_LT(0u, context.cached());
+    }
+
+    // slowly moving area
+    this->assertQuery(TRect(9, 8, 121, 120), context);
+
+    if (TypeParam::depth() > 1)
+    {
+        ASSERT_LT(0u, context.reused());
+    }
+
+    // changing elements outside of the area does not invalidate it as a whole
+    ASSERT_TRUE(this->_quadtree.insert(1000, TRect(1, 1, 2, 2)));
+    this->assertQuery(TRect(9, 8, 121, 120), context);
+
+    if (TypeParam::depth() > 1)
+    {
+        ASSERT_LT(0u, context.reused());
+    }
+}
+
+TYPED_TEST(QContextTest, ShouldMatchTheQueriesWhileTheTreeChanges)
+{
+    TContext context;
+    std::uniform_int_distribution<int> action(0, 9);
+
+    TCoordinate x = 0;
+    TCoordinate y = 10;
+
+    for (TElement frame = 0; frame < 200; frame++)
+    {
+        const auto a = action(this->_generator);
+
+        if (a < 3)
+        {
+            this->insert(1000 + frame);
+        }
+        else if (a < 5 && !this->_elements.empty())
+        {
+            this->remove(static_cast<std::size_t>(frame) % this->_elements.size());
+        }
+        else if (frame % 50 == 49)
+        {
+            this->_quadtree.clear();
+            this->_elements.clear();
+        }
+
+        // the area moves slowly, and from time to time it stays still
+        if (frame % 3 != 0)
+        {
+            x += 0.5f;
+            y += 0.25f;
+        }
+
+        this->assertQuery(TRect(x, y, x + 40, y + 30), context);
+        this->assertQuery(TRect(x, y, x + 40, y + 30), context);
+    }
+
+    context.reset();
+    ASSERT_EQ(0u, context.cached());
+    this->assertQuery(this->_bounds, context);
+}
+
+TYPED_TEST(QContextTest, ShouldNotReuseTheResultsOfADestroyedTree)
+{
+    TContext context;
+    const TRect area(20, 30, 70, 90);
+
+    std::unique_ptr<TypeParam> tree(new TypeParam(this->_bounds));
+    ASSERT_TRUE(tree->insert(1000, TRect(21, 31, 22, 32)));
+
+    typename TestFixture::TElementsContainer elements;
+    tree->query(area, elements, context);
+    ASSERT_EQ((std::vector<TElement>{ 1000 }), this->sorted(elements));
+
+    // the new tree is likely to be allocated at the same address
+    tree.reset();
+    tree.reset(new TypeParam(this->_bounds));
+    ASSERT_TRUE(tree->insert(2000, TRect(21, 31, 22, 32)));
+
+    elements.clear();
+    tree->query(area, elements, context);
+    ASSERT_EQ(0u, context.reused());
+    ASSERT_EQ((std::vector<TElement>{ 2000 }), this->sorted(elements));
+}
+
+TEST(QContextTest, ShouldKeepEpochsOnlyIfRequested)
+{
+    using TTree = quadtree<TElement, TCoordinate, 1>;
+    using TEpochTree = quadtree<TElement, TCoordinate, 1, void, true>;
+
+    ASSERT_FALSE((std::is_base_of<epoch_node<true>, TTree>::value));
+    ASSERT_TRUE((std::is_base_of<epoch_node<true>, TEpochTree>::value));
+    ASSERT_LT(sizeof(TTree), sizeof(TEpochTree));
+
+    const TEpochTree first(TRect(0, 0, 1, 1));
+    const TEpochTree second(TRect(0, 0, 1, 1));
+    ASSERT_NE(first.id(), second.id());
+}
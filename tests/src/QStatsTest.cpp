@@ -0,0 +1,106 @@
+// built into its own executable, where QTREE_ENABLE_STATS is defined for every file
+#ifndef QTREE_ENABLE_STATS
+#error "The traversal counters tests require QTREE_ENABLE_STATS."
+#endif
+#include "quadtree.hpp"
+using namespace qtree;
+
+#include "gtest/gtest.h"
+using namespace testing;
+
+namespace
+{
+    using TCoordinate = float;
+    using TElement = int;
+    using TQuadTree = quadtree<TElement, TCoordinate, 3>;
+    using TElementsContainer = qnode<TElement, TCoordinate>::TElementRefContainer;
+
+    class QStatsTest : public Test
+    {
+    protected:
+
+        QStatsTest()
+            : _qtree({ 0, 0, 8, 8 })
+        {
+            traversal_counters() = qcounters();
+        }
+
+        TQuadTree _qtree;
+    };
+}
+
+TEST_F(QStatsTest, ShouldGetStatsOfEmptyTree)
+{
+    const auto stats = _qtree.stats();
+    EXPECT_EQ(85, stats.nodes);
+    EXPECT_EQ(85, stats.empty_nodes);
+    EXPECT_EQ(0, stats.elements);
+    EXPECT_EQ(0, stats.max_bucket);
+    EXPECT_EQ(0, stats.root_elements());
+    EXPECT_EQ(1, stats.empty_ratio());
+    EXPECT_EQ(std::vector<std::size_t>({ 0, 0, 0, 0 }), stats.level_elements);
+}
+
+TEST_F(QStatsTest, ShouldGetStats)
+{
+    // crossing the root center
+    ASSERT_TRUE(_qtree.insert(0, { 3, 3, 5, 5 }));
+    ASSERT_TRUE(_qtree.insert(1, { 3, 3, 5, 5 }));
+    // level 1
+    ASSERT_TRUE(_qtree.insert(2, { 1, 1, 3, 3 }));
+    // deepest level
+    ASSERT_TRUE(_qtree.insert(3, { 0, 0, 1, 1 }));
+    ASSERT_TRUE(_qtree.insert(4, { 7, 7, 8, 8 }));
+
+    const auto stats = _qtree.stats();
+    EXPECT_EQ(85, stats.nodes);
+    EXPECT_EQ(81, stats.empty_nodes);
+    EXPECT_EQ(5, stats.elements);
+    EXPECT_EQ(2, stats.max_bucket);
+    EXPECT_EQ(2, stats.root_elements());
+    EXPECT_DOUBLE_EQ(81.0 / 85, stats.empty_ratio());
+    EXPECT_EQ(std::vector<std::size_t>({ 2, 1, 0, 2 }), stats.level_elements);
+}
+
+TEST_F(QStatsTest, ShouldCountInsertsAndRemoves)
+{
+    ASSERT_TRUE(_qtree.insert(0, { 3, 3, 5, 5 }));
+    ASSERT_TRUE(_qtree.insert(1, { 0, 0, 1, 1 }));
+    ASSERT_FALSE(_qtree.insert(2, { 0, 0, 9, 9 }));
+
+    const auto counters = traversal_counters();
+    EXPECT_EQ(2, counters.inserts);
+    EXPECT_EQ(0, counters.removes);
+    // the root, and the path from the root to the deepest level
+    EXPECT_EQ(1 + 4, counters.insert_nodes);
+    EXPECT_EQ(0, counters.insert_fallbacks);
+
+    ASSERT_TRUE(_qtree.remove(1, { 0, 0, 1, 1 }));
+    EXPECT_EQ(2, traversal_counters().inserts);
+    EXPECT_EQ(1, traversal_counters().removes);
+}
+
+TEST_F(QStatsTest, ShouldCountQueries)
+{
+    ASSERT_TRUE(_qtree.insert(0, { 3, 3, 5, 5 }));
+    ASSERT_TRUE(_qtree.insert(1, { 0, 0, 1, 1 }));
+    ASSERT_TRUE(_qtree.insert(2, { 1, 0, 2, 1 }));
+
+    TElementsContainer elements;
+    _qtree.query({ 0, 0, 1, 1 }, elements);
+    ASSERT_EQ(1, elements.size());
+
+    const auto counters = traversal_counters();
+    // the area is contained by a node of each level
+    EXPECT_EQ(4, counters.query_nodes);
+    // the element crossing the root center and the one of the deepest node
+    // (the third element belongs to one of its siblings)
+    EXPECT_EQ(2, counters.elements_tested);
+    EXPECT_EQ(1, counters.elements_returned);
+
+    traversal_counters() = qcounters();
+    elements.clear();
+    _qtree.query(elements);
+    EXPECT_EQ(85, traversal_counters().query_nodes);
+    EXPECT_EQ(3, traversal_counters().elements_returned);
+}
@@ -0,0 +1,229 @@
+#include "qview.hpp"
+using namespace qtree;
+
+#include "gtest/gtest.h"
+using namespace testing;
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using TCoordinate = float;
+    using TElement = int;
+
+    template<typename TQuadTree>
+    class QViewTest : public Test
+    {
+    protected:
+
+        using TView = qview<TElement, TCoordinate>;
+
+        QViewTest()
+            : _bounds(_left, _top, _right, _bottom)
+            , _qtree(_bounds)
+        {
+        }
+
+        void insertElements()
+        {
+            TElement element{};
+            const TCoordinate step = (_right - _left) / 16;
+
+            for (TCoordinate x = _left; x < _right; x += step)
+            {
+                for (TCoordinate y = _top; y < _bottom; y += step)
+                {
+                    ASSERT_TRUE(_qtree.insert(element++, { x, y, x + step / 4, y + step / 4 }));
+                    ASSERT_TRUE(_qtree.insert(element++, { x, y, std::min(x + 3 * step, _right), std::min(y + 5 * step, _bottom) }));
+                }
+            }
+        }
+
+        std::string serialized() const
+        {
+            std::ostringstream out;
+            EXPECT_TRUE(serialize(_qtree, out));
+            return out.str();
+        }
+
+        template<typename TContainer>
+        static std::vector<TElement> sorted(const TContainer& elements)
+        {
+            std::vector<TElement> values(std::begin(elements), std::end(elements));
+            std::sort(std::begin(values), std::end(values));
+            return values;
+        }
+
+        void expectSameQueries(const TView& view) const
+        {
+            ASSERT_EQ(_qtree.size(), view.size());
+            ASSERT_EQ(_qtree.empty(), view.empty());
+            ASSERT_EQ(TQuadTree::depth(), view.depth());
+            ASSERT_EQ(_qtree.get_bounds(), view.get_bounds());
+
+            typename qnode<TElement, TCoordinate>::TElementRefContainer expected;
+            typename TView::TElementRefContainer actual;
+            _qtree.query(expected);
+            view.query(actual);
+            ASSERT_EQ(sorted(expected), sorted(actual));
+
+            const rect<TCoordinate> areas[] = {
+                _bounds,
+                { _left + 1, _top + 1, _left + 2, _top + 2 },
+                { _left + 3, _top + 2, _right - 1, _bottom - 4 },
+                { _right - 1, _top, _right, _bottom }
+            };
+
+            for (const auto& area : areas)
+            {
+                expected.clear();
+                actual.clear();
+                _qtree.query(area, expected);
+                view.query(area, actual);
+                ASSERT_EQ(sorted(expected), sorted(actual));
+            }
+        }
+
+        const TCoordinate _left = 10;
+        const TCoordinate _top = 10;
+        const TCoordinate _right = 20;
+        const TCoordinate _bottom = 20;
+
+        const rect<TCoordinate> _bounds;
+
+        TQuadTree _qtree;
+    };
+
+    using QuadTreeTypes = Types<
+        quadtree<TElement, TCoordinate, 1>,
+        quadtree<TElement, TCoordinate, 3>,
+        quadtree<TElement, TCoordinate, 6>>;
+
+    TYPED_TEST_CASE(QViewTest, QuadTreeTypes);
+}
+
+TYPED_TEST(QViewTest, ShouldViewEmptyTree)
+{
+    const auto data = this->serialized();
+    const typename QViewTest<TypeParam>::TView view(data.data(), data.size());
+    this->expectSameQueries(view);
+}
+
+TYPED_TEST(QViewTest, ShouldQueryLikeTheTree)
+{
+    this->insertElements();
+    const auto data = this->serialized();
+    const typename QViewTest<TypeParam>::TView view(data.data(), data.size());
+    this->expectSameQueries(view);
+}
+
+TYPED_TEST(QViewTest, ShouldThrowWhenFormatIsInvalid)
+{
+    using TView = typename QViewTest<TypeParam>::TView;
+
+    this->insertElements();
+    const auto data = this->serialized();
+
+    // truncated
+    EXPECT_THROW(TView(data.data(), 0), std::invalid_argument);
+    EXPECT_THROW(TView(data.data(), data.size() - 1), std::invalid_argument);
+
+    // wrong magic
+    auto invalid = data;
+    invalid[0] = 'X';
+    EXPECT_THROW(TView(invalid.data(), invalid.size()), std::invalid_argument);
+
+    // wrong types
+    EXPECT_THROW((qview<TElement, double>(data.data(), data.size())), std::invalid_argument);
+    EXPECT_THROW((qview<long long, TCoordinate>(data.data(), data.size())), std::invalid_argument);
+}
+
+TYPED_TEST(QViewTest, ShouldQueryMappedFile)
+{
+    this->insertElements();
+    const std::string path = "qview-test-" + std::to_string(TypeParam::depth()) + ".qtree";
+
+    {
+        std::ofstream out(path, std::ios::binary);
+        ASSERT_TRUE(serialize(this->_qtree, out));
+    }
+
+    {
+        const mapped_file file(path);
+        const typename QViewTest<TypeParam>::TView view(file.data(), file.size());
+        this->expectSameQueries(view);
+    }
+
+    std::remove(path.c_str());
+}
+
+TYPED_TEST(QViewTest, ShouldThrowWhenVisitedNodeIsInvalid)
+{
+    using TView = typename QViewTest<TypeParam>::TView;
+
+    this->insertElements();
+    auto data = this->serialized();
+
+    qheader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    const qlayout<TElement, TCoordinate> layout(header.nodes, header.elements);
+
+    // the entry preceding the root one is not validated until the root is visited
+    const auto offset = layout.entries + (header.nodes - 2) * sizeof(qentry);
+    qentry entry;
+    std::memcpy(&entry, data.data() + offset, sizeof(entry));
+    entry.elements = header.elements + 1;
+    std::memcpy(&data[offset], &entry, sizeof(entry));
+
+    const TView view(data.data(), data.size());
+    typename TView::TElementRefContainer elements;
+    EXPECT_THROW(view.query(this->_bounds, elements), std::invalid_argument);
+}
+
+TEST(QViewTest, ShouldNotDependOnTheDepth)
+{
+    quadtree<TElement, TCoordinate, 10> tree({ 0, 0, 1024, 1024 });
+    ASSERT_TRUE(tree.insert(1, { 100, 100, 100.5f, 100.5f }));
+
+    std::ostringstream out;
+    ASSERT_TRUE(serialize(tree, out));
+    const auto data = out.str();
+
+    // one entry for each level from the root to the element node
+    const qlayout<TElement, TCoordinate> layout(11, 1);
+    ASSERT_EQ(layout.size, data.size());
+
+    const qview<TElement, TCoordinate> view(data.data(), data.size());
+    qview<TElement, TCoordinate>::TElementRefContainer elements;
+    view.query({ 99, 99, 101, 101 }, elements);
+    ASSERT_EQ(1u, elements.size());
+    ASSERT_EQ(1, elements.front());
+}
+
+TEST(QViewTest, ShouldZeroTheRecordsPadding)
+{
+    using TRecord = qrecord<char, TCoordinate>;
+    static_assert(sizeof(TRecord) > sizeof(char) + sizeof(rect<TCoordinate>), "The record must have padding.");
+
+    quadtree<char, TCoordinate, 2> tree({ 0, 0, 16, 16 });
+    ASSERT_TRUE(tree.insert('a', { 1, 1, 2, 2 }));
+
+    std::ostringstream out;
+    ASSERT_TRUE(serialize(tree, out));
+    const auto data = out.str();
+
+    const qlayout<char, TCoordinate> layout(3, 1);
+    ASSERT_EQ('a', data[layout.records + offsetof(TRecord, element)]);
+
+    for (auto i = offsetof(TRecord, element) + 1; i < offsetof(TRecord, bounds); i++)
+    {
+        ASSERT_EQ('\0', data[layout.records + i]);
+    }
+}
@@ -5,6 +5,7 @@ using namespace qtree;
 using namespace testing;
 
 #include <algorithm>
+#include <vector>
 
 namespace
 {
@@ -256,3 +257,157 @@ TYPED_TEST(QuadTreeTest, ShouldQueryArea)
     ASSERT_EQ(1, elements.size());
     ASSERT_EQ(element++, elements.front());
 }
+
+TYPED_TEST(QuadTreeTest, ShouldRemove)
+{
+    TElement element{};
+    std::vector<rect<TCoordinate>> bounds;
+
+    // insert elements across the children borders
+    for (TCoordinate x = this->_left; x <= this->_right; x++)
+    {
+        for (TCoordinate y = this->_top; y <= this->_bottom; y++)
+        {
+            const auto right = std::min(x + 1, this->_right);
+            const auto bottom = std::min(y + 1, this->_bottom);
+            bounds.emplace_back(x, y, right, bottom);
+            ASSERT_TRUE(this->_qtree.insert(element++, bounds.back()));
+        }
+    }
+
+    // the element must match both the value and the bounds
+    ASSERT_FALSE(this->_qtree.remove(element, bounds.front()));
+    ASSERT_FALSE(this->_qtree.remove(TElement(), bounds.back()));
+    ASSERT_FALSE(this->_qtree.remove(TElement(), { this->_left - 1, this->_top, this->_right, this->_bottom }));
+
+    element = TElement();
+    std::size_t count = bounds.size();
+
+    for (const auto& b : bounds)
+    {
+        ASSERT_TRUE(this->_qtree.remove(element, b));
+        ASSERT_FALSE(this->_qtree.remove(element++, b));
+        ASSERT_EQ(this->_qtree.size(), --count);
+    }
+
+    ASSERT_TRUE(this->_qtree.empty());
+}
+
+TYPED_TEST(QuadTreeTest, ShouldQueryAreaOverlappingElements)
+{
+    TElement element{};
+    std::vector<rect<TCoordinate>> bounds;
+    const TCoordinate step = (this->_right - this->_left) / 16;
+
+    for (TCoordinate x = this->_left; x < this->_right; x += step)
+    {
+        for (TCoordinate y = this->_top; y < this->_bottom; y += step)
+        {
+            // tiny, small and large rects
+            bounds.emplace_back(x, y, x + step / 8, y + step / 8);
+            bounds.emplace_back(x, y, x + step, y + step);
+            bounds.emplace_back(x, y, std::min(x + 5 * step, this->_right), std::min(y + 3 * step, this->_bottom));
+        }
+    }
+
+    for (const auto& b : bounds)
+    {
+        ASSERT_TRUE(this->_qtree.insert(element++, b));
+    }
+
+    const rect<TCoordinate> areas[] = {
+        this->_bounds,
+        { this->_left + step / 2, this->_top + step / 2, this->_left + 3 * step, this->_top + 7 * step },
+        { this->_left + 7 * step, this->_top + 7 * step, this->_left + 9 * step, this->_top + 9 * step },
+        { this->_right - step, this->_top, this->_right, this->_bottom }
+    };
+
+    for (const auto& area : areas)
+    {
+        typename QuadTreeTest<TypeParam>::TElementsContainer elements;
+        this->_qtree.query(area, elements);
+
+        std::vector<TElement> expected;
+        for (std::size_t i = 0; i < bounds.size(); i++)
+        {
+            if (area.overlaps(bounds[i]))
+            {
+                expected.push_back(static_cast<TElement>(i));
+            }
+        }
+
+        std::vector<TElement> actual(std::begin(elements), std::end(elements));
+        std::sort(std::begin(actual), std::end(actual));
+        ASSERT_EQ(expected, actual);
+    }
+}
+
+namespace
+{
+    /// Element without equality, that cannot be removed from a tree.
+    struct plain_element
+    {
+        int value;
+    };
+}
+
+TEST(QuadTreeTest, ShouldNotRequireEqualityUnlessRemoving)
+{
+    quadtree<plain_element, TCoordinate, 2> tree({ 0, 0, 16, 16 });
+    ASSERT_TRUE(tree.insert({ 1 }, { 1, 1, 2, 2 }));
+    ASSERT_TRUE(tree.insert({ 2 }, { 6, 6, 10, 10 }));
+
+    quadtree<plain_element, TCoordinate, 2>::TElementRefContainer elements;
+    tree.query({ 0, 0, 4, 4 }, elements);
+
+    ASSERT_EQ(1u, elements.size());
+    ASSERT_EQ(1, elements.front().get().value);
+}
+
+TEST(QuadTreeTest, ShouldPlaceIntegerBoundsInTheDeepestNode)
+{
+    constexpr std::size_t depth = 6;
+    const rect<int> bounds(0, 0, 1000, 1000);
+    quadtree<TElement, int, depth> tree(bounds);
+
+    // the children borders are rounded, unlike the Morton cells
+    std::vector<std::size_t> expected(depth + 1);
+    std::vector<rect<int>> elements;
+
+    for (int x = 0; x < 999; x += 7)
+    {
+        for (int y = 0; y < 999; y += 11)
+        {
+            elements.emplace_back(x, y, x + 1, y + 1);
+            ASSERT_TRUE(tree.insert(static_cast<TElement>(elements.size()), elements.back()));
+
+            auto node = bounds;
+            std::size_t level = 0;
+
+            for (std::size_t child = 0; child < 4 && level < depth;)
+            {
+                if (child_bounds(node, child).contains(elements.back()))
+                {
+                    node = child_bounds(node, child);
+                    child = 0;
+                    level++;
+                }
+                else
+                {
+                    child++;
+                }
+            }
+
+            expected[level]++;
+        }
+    }
+
+    ASSERT_EQ(expected, tree.stats().level_elements);
+
+    for (std::size_t i = 0; i < elements.size(); i++)
+    {
+        ASSERT_TRUE(tree.remove(static_cast<TElement>(i + 1), elements[i]));
+    }
+
+    ASSERT_TRUE(tree.empty());
+}
@@ -0,0 +1,186 @@
+#include "octree.hpp"
+#include "quadtree.hpp"
+using namespace qtree;
+
+#include "gtest/gtest.h"
+using namespace testing;
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using TCoordinate = float;
+    using TElement = int;
+    using TRect = rect<TCoordinate>;
+    using TVelocity = std::array<TCoordinate, 2>;
+
+    template<typename TQuadTree>
+    class SweepTest : public Test
+    {
+    protected:
+
+        using THits = typename qnode<TElement, TCoordinate>::TElementHitContainer;
+
+        SweepTest()
+            : _bounds(0, 0, 128, 128)
+            , _quadtree(_bounds)
+        {
+            std::mt19937 generator(11);
+            std::uniform_real_distribution<TCoordinate> position(0, 120);
+            std::uniform_real_distribution<TCoordinate> size(0.1f, 8);
+
+            for (TElement i = 0; i < 400; i++)
+            {
+                const auto x = position(generator);
+                const auto y = position(generator);
+                _elements.emplace_back(i, TRect(x, y, x + size(generator), y + size(generator)));
+                _quadtree.insert(_elements.back().first, _elements.back().second);
+            }
+        }
+
+        /// Sweeps all the elements without the tree.
+        std::vector<std::pair<TElement, double>> expected(const TRect& bounds, const TVelocity& velocity, double duration) const
+        {
+            std::vector<std::pair<TElement, double>> hits;
+
+            for (const auto& e : _elements)
+            {
+                double time;
+
+                if (sweep_bounds(bounds, velocity, e.second, duration, time))
+                {
+                    hits.emplace_back(e.first, time);
+                }
+            }
+
+            return hits;
+        }
+
+        const TRect _bounds;
+        std::vector<std::pair<TElement, TRect>> _elements;
+
+        TQuadTree _quadtree;
+    };
+
+    using SweepTypes = Types<
+        quadtree<TElement, TCoordinate, 1>,
+        quadtree<TElement, TCoordinate, 3>,
+        quadtree<TElement, TCoordinate, 5>>;
+
+    TYPED_TEST_CASE(SweepTest, SweepTypes);
+}
+
+
+TEST(SweepBoundsTest, ShouldGetTheTimeOfImpact)
+{
+    double time = -1;
+
+    // moving towards the target
+    ASSERT_TRUE(sweep_bounds(TRect(0, 0, 1, 1), TVelocity{ 10, 0 }, TRect(5, 0, 6, 1), 1, time));
+    ASSERT_DOUBLE_EQ(0.4, time);
+
+    ASSERT_TRUE(sweep_bounds(TRect(10, 10, 11, 11), TVelocity{ -2, -4 }, TRect(0, 0, 9, 9), 1, time));
+    ASSERT_DOUBLE_EQ(0.5, time);
+
+    // thin target crossed during the time step, missed at both its ends
+    ASSERT_FALSE(TRect(0, 0, 1, 1).overlaps(TRect(5, 0, 5.1f, 1)));
+    ASSERT_FALSE(TRect(10, 0, 11, 1).overlaps(TRect(5, 0, 5.1f, 1)));
+    ASSERT_TRUE(sweep_bounds(TRect(0, 0, 1, 1), TVelocity{ 10, 0 }, TRect(5, 0, 5.1f, 1), 1, time));
+    ASSERT_DOUBLE_EQ(0.4, time);
+
+    // already overlapping, even without moving
+    ASSERT_TRUE(sweep_bounds(TRect(0, 0, 2, 2), TVelocity{ 10, 0 }, TRect(1, 1, 3, 3), 1, time));
+    ASSERT_DOUBLE_EQ(0, time);
+    ASSERT_TRUE(sweep_bounds(TRect(0, 0, 2, 2), TVelocity{ 0, 0 }, TRect(1, 1, 3, 3), 0, time));
+    ASSERT_DOUBLE_EQ(0, time);
+}
+
+TEST(SweepBoundsTest, ShouldMissTheTarget)
+{
+    double time = -1;
+
+    // moving away
+    ASSERT_FALSE(sweep_bounds(TRect(0, 0, 1, 1), TVelocity{ -10, 0 }, TRect(5, 0, 6, 1), 1, time));
+    // reaching the target after the time step
+    ASSERT_FALSE(sweep_bounds(TRect(0, 0, 1, 1), TVelocity{ 1, 0 }, TRect(5, 0, 6, 1), 1, time));
+    // passing beside the target
+    ASSERT_FALSE(sweep_bounds(TRect(0, 2, 1, 3), TVelocity{ 10, 0 }, TRect(5, 0, 6, 1), 1, time));
+    // only touching the target
+    ASSERT_FALSE(sweep_bounds(TRect(0, 0, 1, 1), TVelocity{ 4, 0 }, TRect(5, 0, 6, 1), 1, time));
+    ASSERT_FALSE(sweep_bounds(TRect(0, 1, 1, 2), TVelocity{ 10, 0 }, TRect(5, 0, 6, 1), 1, time));
+    // crossing each axis at different times
+    ASSERT_FALSE(sweep_bounds(TRect(0, 0, 1, 1), TVelocity{ 10, 10 }, TRect(5, 0, 6, 1), 1, time));
+
+    ASSERT_DOUBLE_EQ(-1, time);
+}
+
+TYPED_TEST(SweepTest, ShouldSweepLikeTheBruteForce)
+{
+    const std::pair<TRect, TVelocity> sweeps[] = {
+        { TRect(0, 0, 1, 1), TVelocity{ 120, 120 } },
+        { TRect(64, 0, 66, 2), TVelocity{ 0, 126 } },
+        { TRect(127, 60, 128, 61), TVelocity{ -500, 10 } },
+        { TRect(30, 30, 40, 40), TVelocity{ 0, 0 } },
+        { TRect(200, 200, 201, 201), TVelocity{ -10, -10 } }
+    };
+
+    for (const auto& s : sweeps)
+    {
+        auto expected = this->expected(s.first, s.second, 1);
+
+        typename TestFixture::THits hits;
+        this->_quadtree.sweep(s.first, s.second, 1, hits);
+
+        ASSERT_EQ(expected.size(), hits.size());
+        ASSERT_TRUE(std::is_sorted(hits.begin(), hits.end(),
+            [](const typename TestFixture::THits::value_type& lhs, const typename TestFixture::THits::value_type& rhs)
+            {
+                return lhs.second < rhs.second;
+            }));
+
+        std::vector<std::pair<TElement, double>> found;
+
+        for (const auto& hit : hits)
+        {
+            found.emplace_back(hit.first, hit.second);
+        }
+
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        ASSERT_EQ(expected, found);
+    }
+}
+
+TYPED_TEST(SweepTest, ShouldAppendTheHits)
+{
+    typename TestFixture::THits hits;
+    this->_quadtree.sweep(TRect(0, 0, 1, 1), TVelocity{ 120, 120 }, 1, hits);
+
+    const auto size = hits.size();
+    ASSERT_LT(0u, size);
+
+    this->_quadtree.sweep(TRect(0, 0, 1, 1), TVelocity{ 120, 120 }, 1, hits);
+    ASSERT_EQ(2 * size, hits.size());
+}
+
+TEST(SweepOctreeTest, ShouldSweepTheElements)
+{
+    using TBox = box<TCoordinate, 3>;
+    octree<TElement, TCoordinate, 2> tree(TBox({ 0, 0, 0 }, { 16, 16, 16 }));
+
+    ASSERT_TRUE(tree.insert(1, TBox({ 10, 1, 1 }, { 11, 2, 2 })));
+    ASSERT_TRUE(tree.insert(2, TBox({ 5, 1, 1 }, { 6, 2, 2 })));
+    ASSERT_TRUE(tree.insert(3, TBox({ 5, 8, 8 }, { 6, 9, 9 })));
+
+    qnode<TElement, TCoordinate, TBox>::TElementHitContainer hits;
+    tree.sweep(TBox({ 0, 1, 1 }, { 1, 2, 2 }), { 20, 0, 0 }, 1, hits);
+
+    ASSERT_EQ(2u, hits.size());
+    ASSERT_EQ(2, hits[0].first);
+    ASSERT_DOUBLE_EQ(0.2, hits[0].second);
+    ASSERT_EQ(1, hits[1].first);
+    ASSERT_DOUBLE_EQ(0.45, hits[1].second);
+}